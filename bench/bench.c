@@ -0,0 +1,198 @@
+#define _POSIX_C_SOURCE 199309L  // for clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "wasm.h"
+
+#define own
+
+// Microbenchmarks for the embedding hot paths. Every benchmark prints one
+// JSON object per line, e.g.
+//   {"api":"c","bench":"call_0","iterations":1000000,"ns_per_op":21.5}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(const char* name, size_t iterations, void (*f)(void)) {
+  for (size_t i = 0; i < iterations / 10 + 1; ++i) f();  // warm up
+  double start = now_ns();
+  for (size_t i = 0; i < iterations; ++i) f();
+  double ns = now_ns() - start;
+  printf("{\"api\":\"c\",\"bench\":\"%s\",\"iterations\":%zu,\"ns_per_op\":%.1f}\n",
+    name, iterations, ns / iterations);
+  fflush(stdout);
+}
+
+static void check(bool ok, const char* what) {
+  if (!ok) {
+    fprintf(stderr, "> Error %s!\n", what);
+    exit(1);
+  }
+}
+
+static own wasm_trap_t* host_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  return NULL;
+}
+
+
+// Benchmark state.
+static wasm_engine_t* engine;
+static wasm_store_t* store;
+static wasm_byte_vec_t binary;
+static wasm_byte_vec_t serialized;
+static wasm_module_t* module;
+static wasm_shared_module_t* shared;
+static wasm_extern_vec_t imports;
+static wasm_func_t* funcs[5];
+static wasm_memory_t* memory;
+
+static wasm_val_vec_t no_vals = WASM_EMPTY_VEC;
+static wasm_val_t args4_data[4];
+static wasm_val_t args16_data[16];
+static wasm_val_t args2_data[2];
+static wasm_val_t results_data[2];
+static wasm_val_vec_t args4 = WASM_ARRAY_VEC(args4_data);
+static wasm_val_vec_t args16 = WASM_ARRAY_VEC(args16_data);
+static wasm_val_vec_t args2 = WASM_ARRAY_VEC(args2_data);
+static wasm_val_vec_t result1 = {1, results_data};
+static wasm_val_vec_t results2 = {2, results_data};
+
+static void call(const wasm_func_t* func, wasm_val_vec_t* args, wasm_val_vec_t* results) {
+  own wasm_trap_t* trap = wasm_func_call(func, args, results);
+  check(!trap, "calling function");
+}
+
+static void bench_host_round_trip(void) { call(funcs[0], &no_vals, &no_vals); }
+static void bench_call_0(void) { call(funcs[1], &no_vals, &no_vals); }
+static void bench_call_4(void) { call(funcs[2], &args4, &result1); }
+static void bench_call_16(void) { call(funcs[3], &args16, &result1); }
+static void bench_call_multi(void) { call(funcs[4], &args2, &results2); }
+
+static void bench_instance_new(void) {
+  own wasm_instance_t* instance = wasm_instance_new(store, module, &imports, NULL);
+  check(instance, "instantiating module");
+  wasm_instance_delete(instance);
+}
+
+static void bench_store_new(void) {
+  own wasm_store_t* new_store = wasm_store_new(engine);
+  check(new_store, "creating store");
+  wasm_store_delete(new_store);
+}
+
+static void bench_module_new(void) {
+  own wasm_module_t* new_module = wasm_module_new(store, &binary);
+  check(new_module, "compiling module");
+  wasm_module_delete(new_module);
+}
+
+static void bench_module_deserialize(void) {
+  own wasm_module_t* new_module = wasm_module_deserialize(store, &serialized);
+  check(new_module, "deserializing module");
+  wasm_module_delete(new_module);
+}
+
+static void bench_module_obtain(void) {
+  own wasm_module_t* new_module = wasm_module_obtain(store, shared);
+  check(new_module, "obtaining module");
+  wasm_module_delete(new_module);
+}
+
+static void bench_memory_grow(void) {
+  check(wasm_memory_grow(memory, 1), "growing memory");
+}
+
+static volatile size_t sink;
+
+static void bench_memory_data(void) {
+  sink = sink + wasm_memory_data_size(memory) + (wasm_memory_data(memory) != NULL);
+}
+
+
+int main(int argc, const char* argv[]) {
+  engine = wasm_engine_new();
+  store = wasm_store_new(engine);
+
+  // Load binary.
+  FILE* file = fopen("bench.wasm", "rb");
+  check(file, "loading module");
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  check(fread(binary.data, file_size, 1, file) == 1, "loading module");
+  fclose(file);
+
+  module = wasm_module_new(store, &binary);
+  check(module, "compiling module");
+
+  own wasm_functype_t* host_type = wasm_functype_new_0_0();
+  own wasm_func_t* host_func = wasm_func_new(store, host_type, host_callback);
+  wasm_functype_delete(host_type);
+  wasm_extern_t* externs[] = { wasm_func_as_extern(host_func) };
+  imports.size = 1;
+  imports.data = externs;
+
+  own wasm_instance_t* instance = wasm_instance_new(store, module, &imports, NULL);
+  check(instance, "instantiating module");
+
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  check(exports.size == 5, "accessing exports");
+  for (size_t i = 0; i < 5; ++i) {
+    funcs[i] = wasm_extern_as_func(exports.data[i]);
+    check(funcs[i], "accessing exports");
+  }
+
+  // Calls.
+  for (size_t i = 0; i < 4; ++i) args4_data[i] = (wasm_val_t)WASM_I32_VAL(i);
+  for (size_t i = 0; i < 16; ++i) args16_data[i] = (wasm_val_t)WASM_I32_VAL(i);
+  for (size_t i = 0; i < 2; ++i) args2_data[i] = (wasm_val_t)WASM_I32_VAL(i);
+
+  bench("host_round_trip", 1000000, bench_host_round_trip);
+  bench("call_0", 1000000, bench_call_0);
+  bench("call_4", 1000000, bench_call_4);
+  bench("call_16", 1000000, bench_call_16);
+  bench("call_multi", 1000000, bench_call_multi);
+
+  // Creation.
+  bench("instance_make", 10000, bench_instance_new);
+  bench("store_make", 100, bench_store_new);
+
+  // Modules.
+  wasm_module_serialize(module, &serialized);
+  shared = wasm_module_share(module);
+  bench("module_make", 100, bench_module_new);
+  bench("module_deserialize", 100, bench_module_deserialize);
+  bench("module_obtain", 1000, bench_module_obtain);
+
+  // Memories.
+  wasm_limits_t limits = { 0, wasm_limits_max_default };
+  own wasm_memorytype_t* memory_type = wasm_memorytype_new(&limits);
+  memory = wasm_memory_new(store, memory_type);
+  wasm_memorytype_delete(memory_type);
+  check(memory, "creating memory");
+  bench("memory_grow", 1000, bench_memory_grow);
+  bench("memory_data", 1000000, bench_memory_data);
+
+  // Shut down.
+  wasm_memory_delete(memory);
+  wasm_shared_module_delete(shared);
+  wasm_byte_vec_delete(&serialized);
+  wasm_extern_vec_delete(&exports);
+  wasm_instance_delete(instance);
+  wasm_func_delete(host_func);
+  wasm_module_delete(module);
+  wasm_byte_vec_delete(&binary);
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+  return 0;
+}
@@ -0,0 +1,139 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "wasm.hh"
+
+// Microbenchmarks for the embedding hot paths. Every benchmark prints one
+// JSON object per line, e.g.
+//   {"api":"c++","bench":"call_0","iterations":1000000,"ns_per_op":21.5}
+
+template<class F>
+void bench(const char* name, size_t iterations, F&& f) {
+  for (size_t i = 0; i < iterations / 10 + 1; ++i) f();  // warm up
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) f();
+  std::chrono::duration<double, std::nano> ns =
+    std::chrono::steady_clock::now() - start;
+  std::printf(
+    "{\"api\":\"c++\",\"bench\":\"%s\",\"iterations\":%zu,\"ns_per_op\":%.1f}\n",
+    name, iterations, ns.count() / iterations);
+  std::fflush(stdout);
+}
+
+void check(bool ok, const char* what) {
+  if (!ok) {
+    std::fprintf(stderr, "> Error %s!\n", what);
+    exit(1);
+  }
+}
+
+auto host_callback(
+  const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  return nullptr;
+}
+
+
+void run() {
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::ifstream file("bench.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  check(!file.fail(), "loading module");
+
+  auto module = wasm::Module::make(store, binary);
+  check(!!module, "compiling module");
+
+  auto host_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(), wasm::ownvec<wasm::ValType>::make());
+  auto host_func = wasm::Func::make(store, host_type.get(), host_callback);
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  check(!!instance, "instantiating module");
+
+  auto exports = instance->exports();
+  check(exports.size() == 5, "accessing exports");
+  auto call_host_func = exports[0]->func();
+  auto nop_func = exports[1]->func();
+  auto add4_func = exports[2]->func();
+  auto add16_func = exports[3]->func();
+  auto swap_func = exports[4]->func();
+
+  // Calls.
+  auto no_vals = wasm::vec<wasm::Val>::make();
+  auto args4 = wasm::vec<wasm::Val>::make_uninitialized(4);
+  auto args16 = wasm::vec<wasm::Val>::make_uninitialized(16);
+  auto args2 = wasm::vec<wasm::Val>::make_uninitialized(2);
+  for (size_t i = 0; i < 4; ++i) args4[i] = wasm::Val::i32(i);
+  for (size_t i = 0; i < 16; ++i) args16[i] = wasm::Val::i32(i);
+  for (size_t i = 0; i < 2; ++i) args2[i] = wasm::Val::i32(i);
+  auto result1 = wasm::vec<wasm::Val>::make_uninitialized(1);
+  auto results2 = wasm::vec<wasm::Val>::make_uninitialized(2);
+
+  bench("host_round_trip", 1000000, [&] {
+    check(!call_host_func->call(no_vals, no_vals), "calling call_host");
+  });
+  bench("call_0", 1000000, [&] {
+    check(!nop_func->call(no_vals, no_vals), "calling nop");
+  });
+  bench("call_4", 1000000, [&] {
+    check(!add4_func->call(args4, result1), "calling add4");
+  });
+  bench("call_16", 1000000, [&] {
+    check(!add16_func->call(args16, result1), "calling add16");
+  });
+  bench("call_multi", 1000000, [&] {
+    check(!swap_func->call(args2, results2), "calling swap");
+  });
+
+  // Creation.
+  bench("instance_make", 10000, [&] {
+    check(!!wasm::Instance::make(store, module.get(), imports),
+      "instantiating module");
+  });
+  bench("store_make", 100, [&] {
+    check(!!wasm::Store::make(engine.get()), "creating store");
+  });
+
+  // Modules.
+  auto serialized = module->serialize();
+  auto shared = module->share();
+  bench("module_make", 100, [&] {
+    check(!!wasm::Module::make(store, binary), "compiling module");
+  });
+  bench("module_deserialize", 100, [&] {
+    check(!!wasm::Module::deserialize(store, serialized),
+      "deserializing module");
+  });
+  bench("module_obtain", 1000, [&] {
+    check(!!wasm::Module::obtain(store, shared.get()), "obtaining module");
+  });
+
+  // Memories.
+  auto memory_type = wasm::MemoryType::make(wasm::Limits(0));
+  auto memory = wasm::Memory::make(store, memory_type.get());
+  check(!!memory, "creating memory");
+  bench("memory_grow", 1000, [&] {
+    check(memory->grow(1), "growing memory");
+  });
+  volatile size_t sink = 0;
+  bench("memory_data", 1000000, [&] {
+    sink = sink + memory->data_size() + (memory->data() != nullptr);
+  });
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  return 0;
+}
@@ -0,0 +1,29 @@
+(module
+  (func $host (import "" "host"))
+
+  (func (export "call_host") (call $host))
+
+  (func (export "nop"))
+
+  (func (export "add4") (param i32 i32 i32 i32) (result i32)
+    (i32.add (i32.add (local.get 0) (local.get 1))
+             (i32.add (local.get 2) (local.get 3)))
+  )
+
+  (func (export "add16")
+    (param i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32)
+    (result i32)
+    (i32.add (i32.add (i32.add (i32.add (local.get 0) (local.get 1))
+                               (i32.add (local.get 2) (local.get 3)))
+                      (i32.add (i32.add (local.get 4) (local.get 5))
+                               (i32.add (local.get 6) (local.get 7))))
+             (i32.add (i32.add (i32.add (local.get 8) (local.get 9))
+                               (i32.add (local.get 10) (local.get 11)))
+                      (i32.add (i32.add (local.get 12) (local.get 13))
+                               (i32.add (local.get 14) (local.get 15)))))
+  )
+
+  (func (export "swap") (param i32 i32) (result i32 i32)
+    (local.get 1) (local.get 0)
+  )
+)
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+
+typedef struct compilation_t {
+  bool settled;
+  own wasm_module_t* module;
+} compilation_t;
+
+void compiled_callback(void* env, own wasm_module_t* module) {
+  printf("Calling back...\n");
+  compilation_t* result = (compilation_t*)env;
+  printf("> %s\n", module ? "Compiled" : "Failed");
+  result->settled = true;
+  result->module = module;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("async.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile in the background.
+  printf("Compiling module asynchronously...\n");
+  compilation_t good = {false, NULL};
+  compilation_t bad = {false, NULL};
+  wasm_module_new_async(store, &binary, compiled_callback, &good);
+  wasm_byte_vec_t truncated;
+  wasm_byte_vec_new(&truncated, binary.size - 1, binary.data);
+  wasm_module_new_async(store, &truncated, compiled_callback, &bad);
+  wasm_byte_vec_delete(&truncated);
+
+  // Wait for both.
+  printf("Polling...\n");
+  while (wasm_store_poll(store, true) > 0) {}
+  if (!good.settled || !bad.settled) {
+    printf("> Error polling, compilation still pending!\n");
+    return 1;
+  }
+  if (!good.module || bad.module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, good.module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  // Extract export.
+  printf("Extracting export...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size == 0) {
+    printf("> Error accessing exports!\n");
+    return 1;
+  }
+  const wasm_func_t* answer_func = wasm_extern_as_func(exports.data[0]);
+  if (answer_func == NULL) {
+    printf("> Error accessing export!\n");
+    return 1;
+  }
+
+  wasm_module_delete(good.module);
+  wasm_instance_delete(instance);
+
+  // Call.
+  printf("Calling export...\n");
+  wasm_val_t rs[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_EMPTY_VEC;
+  wasm_val_vec_t results = WASM_ARRAY_VEC(rs);
+  if (wasm_func_call(answer_func, &args, &results)) {
+    printf("> Error calling function!\n");
+    return 1;
+  }
+
+  wasm_extern_vec_delete(&exports);
+
+  // Print result.
+  printf("Printing result...\n");
+  printf("> %u\n", rs[0].of.i32);
+
+  // Pending compilations are cancelled with the store.
+  printf("Abandoning compilation...\n");
+  compilation_t abandoned = {false, NULL};
+  wasm_module_new_async(store, &binary, compiled_callback, &abandoned);
+  wasm_byte_vec_delete(&binary);
+  wasm_store_delete(store);
+  if (!abandoned.settled || abandoned.module) {
+    printf("> Error deleting store, expected failed callback!\n");
+    return 1;
+  }
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+#include <algorithm>
+
+#include "wasm.hh"
+
+
+struct compilation {
+  bool settled = false;
+  wasm::own<wasm::Module> module;
+};
+
+void compiled_callback(void* env, wasm::own<wasm::Module>&& module) {
+  std::cout << "Calling back..." << std::endl;
+  auto result = static_cast<compilation*>(env);
+  std::cout << "> " << (module ? "Compiled" : "Failed") << std::endl;
+  result->settled = true;
+  result->module = std::move(module);
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("async.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile in the background.
+  std::cout << "Compiling module asynchronously..." << std::endl;
+  compilation good, bad;
+  wasm::Module::make_async(store, binary, compiled_callback, &good);
+  auto truncated = wasm::vec<byte_t>::make_uninitialized(binary.size() - 1);
+  std::copy(binary.get(), binary.get() + truncated.size(), truncated.get());
+  wasm::Module::make_async(store, truncated, compiled_callback, &bad);
+
+  // Wait for both.
+  std::cout << "Polling..." << std::endl;
+  while (store->poll(true) > 0) {}
+  if (!good.settled || !bad.settled) {
+    std::cout << "> Error polling, compilation still pending!" << std::endl;
+    exit(1);
+  }
+  if (!good.module || bad.module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, good.module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting export..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || exports[0]->kind() != wasm::ExternKind::FUNC || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto answer_func = exports[0]->func();
+
+  // Call.
+  std::cout << "Calling export..." << std::endl;
+  auto args = wasm::vec<wasm::Val>::make();
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (answer_func->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+
+  // Print result.
+  std::cout << "Printing result..." << std::endl;
+  std::cout << "> " << results[0].i32() << std::endl;
+
+  // Pending compilations are cancelled with the store.
+  std::cout << "Abandoning compilation..." << std::endl;
+  compilation abandoned;
+  wasm::Module::make_async(store, binary, compiled_callback, &abandoned);
+  exports.reset();
+  instance.reset();
+  good.module.reset();
+  store_.reset();
+  if (!abandoned.settled || abandoned.module) {
+    std::cout << "> Error destroying store, expected failed callback!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
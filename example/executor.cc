@@ -0,0 +1,123 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "wasm.hh"
+
+const int N_THREADS = 4;
+const int N_CALLS = 100;
+
+
+void sum_callback(
+  void* env, const wasm::vec<wasm::Val>& results, const wasm::Message* trap
+) {
+  if (trap) return;
+  *static_cast<std::atomic<int32_t>*>(env) += results[0].i32();
+}
+
+void expect_trap(wasm::Executor* executor, size_t index, wasm::vec<wasm::Val>&& args) {
+  auto result = executor->submit(index, std::move(args)).get();
+  if (!result.trap) {
+    std::cout << "> Error calling export #" << index << ", expected trap!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << result.trap.get() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("executor.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile and share.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  auto shared = module->share();
+
+  // Start workers.
+  std::cout << "Starting executor..." << std::endl;
+  auto executor = wasm::Executor::make(engine.get(), shared.get(), N_THREADS);
+  if (!executor || executor->threads() != N_THREADS) {
+    std::cout << "> Error starting executor!" << std::endl;
+    exit(1);
+  }
+
+  // Submit calls with futures.
+  std::cout << "Submitting calls..." << std::endl;
+  std::vector<std::future<wasm::Executor::Result>> futures;
+  for (int i = 0; i < N_CALLS; ++i) {
+    futures.push_back(executor->submit(0,
+      wasm::vec<wasm::Val>::make(wasm::Val::i32(i), wasm::Val::i32(1))));
+  }
+  int32_t sum = 0;
+  for (auto& future: futures) {
+    auto result = future.get();
+    if (result.trap || result.results.size() != 1) {
+      std::cout << "> Error calling export!" << std::endl;
+      exit(1);
+    }
+    sum += result.results[0].i32();
+  }
+  std::cout << "> " << sum << std::endl;
+
+  // Submit calls with callbacks; destroying the executor finishes them.
+  std::cout << "Submitting callbacks..." << std::endl;
+  std::atomic<int32_t> total(0);
+  for (int i = 0; i < N_CALLS; ++i) {
+    executor->submit(0,
+      wasm::vec<wasm::Val>::make(wasm::Val::i32(i), wasm::Val::i32(1)),
+      sum_callback, &total);
+  }
+
+  // Submit invalid calls.
+  std::cout << "Submitting invalid calls..." << std::endl;
+  expect_trap(executor.get(), 0, wasm::vec<wasm::Val>::make(wasm::Val::i32(1)));
+  expect_trap(executor.get(), 0,
+    wasm::vec<wasm::Val>::make(wasm::Val::i64(1), wasm::Val::i32(1)));
+  expect_trap(executor.get(), 1, wasm::vec<wasm::Val>::make(wasm::Val()));
+  expect_trap(executor.get(), 2, wasm::vec<wasm::Val>::make());
+  expect_trap(executor.get(), 3, wasm::vec<wasm::Val>::make());
+
+  executor.reset();
+  std::cout << "> " << total.load() << std::endl;
+  if (total.load() != sum) {
+    std::cout << "> Error running callbacks!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,7 @@
+(module
+  (func (export "add") (param i32 i32) (result i32)
+    (i32.add (local.get 0) (local.get 1))
+  )
+  (func (export "id") (param anyref) (result anyref) (local.get 0))
+  (global (export "zero") i32 (i32.const 0))
+)
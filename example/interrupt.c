@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "wasm.h"
+
+#define own
+
+
+typedef struct interrupter_args {
+  wasm_store_t* store;
+  atomic_bool done;
+} interrupter_args;
+
+// Interrupts are dropped while no call is running, so keep trying.
+void* interrupter(void* args_abs) {
+  interrupter_args* args = (interrupter_args*)args_abs;
+  while (!atomic_load(&args->done)) {
+    usleep(10000);
+    wasm_store_interrupt(args->store);
+  }
+  return NULL;
+}
+
+int expect_interrupted(const wasm_func_t* func) {
+  wasm_val_vec_t empty = WASM_EMPTY_VEC;
+  own wasm_trap_t* trap = wasm_func_call(func, &empty, &empty);
+  if (!trap || !wasm_trap_interrupted(trap)) {
+    printf("> Error calling function, expected interruption!\n");
+    return 0;
+  }
+  own wasm_message_t message;
+  wasm_trap_message(trap, &message);
+  printf("> %s\n", message.data);
+  wasm_name_delete(&message);
+  wasm_trap_delete(trap);
+  return 1;
+}
+
+int expect_answer(const wasm_func_t* func) {
+  wasm_val_t rs[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_EMPTY_VEC;
+  wasm_val_vec_t results = WASM_ARRAY_VEC(rs);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    return 0;
+  }
+  printf("> %u\n", rs[0].of.i32);
+  return 1;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("interrupt.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  // Extract exports.
+  printf("Extracting exports...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size < 2) {
+    printf("> Error accessing exports!\n");
+    return 1;
+  }
+  const wasm_func_t* spin_func = wasm_extern_as_func(exports.data[0]);
+  const wasm_func_t* answer_func = wasm_extern_as_func(exports.data[1]);
+  if (spin_func == NULL || answer_func == NULL) {
+    printf("> Error accessing export!\n");
+    return 1;
+  }
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Interrupt from another thread.
+  printf("Interrupting spin...\n");
+  interrupter_args args;
+  args.store = store;
+  atomic_init(&args.done, false);
+  pthread_t thread;
+  pthread_create(&thread, NULL, &interrupter, &args);
+  if (!expect_interrupted(spin_func)) return 1;
+  atomic_store(&args.done, true);
+  pthread_join(thread, NULL);
+
+  // Later calls run normally.
+  printf("Calling answer...\n");
+  if (!expect_answer(answer_func)) return 1;
+
+  // Time out.
+  printf("Timing out spin...\n");
+  wasm_store_set_timeout(store, 50);
+  if (!expect_interrupted(spin_func)) return 1;
+  if (!expect_interrupted(spin_func)) return 1;
+
+  // Calls within the timeout complete.
+  printf("Calling answer...\n");
+  if (!expect_answer(answer_func)) return 1;
+  wasm_store_set_timeout(store, 0);
+
+  wasm_extern_vec_delete(&exports);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "wasm.hh"
+
+
+// Interrupts are dropped while no call is running, so keep trying.
+void interrupter(wasm::Store* store, std::atomic<bool>* done) {
+  while (!done->load()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    store->interrupt();
+  }
+}
+
+void expect_interrupted(const wasm::Func* func) {
+  auto empty = wasm::vec<wasm::Val>::make();
+  auto trap = func->call(empty, empty);
+  if (!trap || !trap->interrupted()) {
+    std::cout << "> Error calling function, expected interruption!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << trap->message().get() << std::endl;
+}
+
+void expect_answer(const wasm::Func* func) {
+  auto args = wasm::vec<wasm::Val>::make();
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (func->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << results[0].i32() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("interrupt.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract exports.
+  std::cout << "Extracting exports..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() < 2 || !exports[0]->func() || !exports[1]->func()) {
+    std::cout << "> Error accessing exports!" << std::endl;
+    exit(1);
+  }
+  auto spin_func = exports[0]->func();
+  auto answer_func = exports[1]->func();
+
+  // Interrupt from another thread.
+  std::cout << "Interrupting spin..." << std::endl;
+  std::atomic<bool> done(false);
+  std::thread thread(interrupter, store, &done);
+  expect_interrupted(spin_func);
+  done.store(true);
+  thread.join();
+
+  // Later calls run normally.
+  std::cout << "Calling answer..." << std::endl;
+  expect_answer(answer_func);
+
+  // Time out.
+  std::cout << "Timing out spin..." << std::endl;
+  store->set_timeout(50);
+  expect_interrupted(spin_func);
+  expect_interrupted(spin_func);
+
+  // Calls within the timeout complete.
+  std::cout << "Calling answer..." << std::endl;
+  expect_answer(answer_func);
+  store->set_timeout(0);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
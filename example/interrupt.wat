@@ -0,0 +1,4 @@
+(module
+  (func (export "spin") (loop $l (br $l)))
+  (func (export "answer") (result i32) (i32.const 42))
+)
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// A function to be called from Wasm code.
+own wasm_trap_t* host_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  return NULL;
+}
+
+
+uint64_t histogram_count(const uint64_t histogram[]) {
+  uint64_t count = 0;
+  for (size_t i = 0; i < WASM_METRICS_HISTOGRAM_SIZE; ++i) {
+    count += histogram[i];
+  }
+  return count;
+}
+
+void print_metrics(const wasm_store_metrics_t* metrics) {
+  printf("> compilations: %" PRIu64 " (%" PRIu64 " ns)\n",
+    metrics->compilations, metrics->compile_ns);
+  printf("> instantiations: %" PRIu64 " (%" PRIu64 " ns)\n",
+    metrics->instantiations, metrics->instantiate_ns);
+  printf("> guest calls: %" PRIu64 "\n", metrics->guest_calls);
+  printf("> host calls: %" PRIu64 "\n", metrics->host_calls);
+  printf("> live handles: %zu\n", metrics->live_handles);
+  printf("> external bytes: %zu\n", metrics->external_bytes);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("metrics.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create external function.
+  printf("Creating callback...\n");
+  own wasm_functype_t* host_type = wasm_functype_new_0_0();
+  own wasm_func_t* host_func =
+    wasm_func_new(store, host_type, host_callback);
+
+  wasm_functype_delete(host_type);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_t* externs[] = { wasm_func_as_extern(host_func) };
+  wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  wasm_func_delete(host_func);
+
+  // Extract export.
+  printf("Extracting export...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size == 0) {
+    printf("> Error accessing exports!\n");
+    return 1;
+  }
+  const wasm_func_t* run_func = wasm_extern_as_func(exports.data[0]);
+  if (run_func == NULL) {
+    printf("> Error accessing export!\n");
+    return 1;
+  }
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Call.
+  printf("Calling export...\n");
+  for (int32_t i = 0; i < 3; ++i) {
+    wasm_val_t args_val[] = { WASM_I32_VAL(i) };
+    wasm_val_t results_val[] = { WASM_INIT_VAL };
+    wasm_val_vec_t args = WASM_ARRAY_VEC(args_val);
+    wasm_val_vec_t results = WASM_ARRAY_VEC(results_val);
+    if (wasm_func_call(run_func, &args, &results)) {
+      printf("> Error calling function!\n");
+      return 1;
+    }
+  }
+
+  wasm_extern_vec_delete(&exports);
+
+  // Print metrics.
+  printf("Printing metrics...\n");
+  wasm_store_metrics_t metrics;
+  wasm_store_metrics(store, &metrics);
+  print_metrics(&metrics);
+  if (metrics.compilations != 1 || metrics.instantiations != 1 ||
+      metrics.guest_calls != 3 || metrics.host_calls != 3 ||
+      histogram_count(metrics.guest_call_ns) != metrics.guest_calls ||
+      histogram_count(metrics.host_call_ns) != metrics.host_calls) {
+    printf("> Error on metrics!\n");
+    return 1;
+  }
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
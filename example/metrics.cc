@@ -0,0 +1,139 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// A function to be called from Wasm code.
+auto host_callback(
+  const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  return nullptr;
+}
+
+
+template<class T, class U>
+void check(T actual, U expected) {
+  if (actual != expected) {
+    std::cout << "> Error on result, expected " << expected << ", got " << actual << std::endl;
+    exit(1);
+  }
+}
+
+auto histogram_count(const uint64_t histogram[]) -> uint64_t {
+  uint64_t count = 0;
+  for (size_t i = 0; i < wasm::Store::Metrics::histogram_size; ++i) {
+    count += histogram[i];
+  }
+  return count;
+}
+
+void print_metrics(const wasm::Store::Metrics& metrics) {
+  std::cout << "> compilations: " << metrics.compilations
+    << " (" << metrics.compile_ns << " ns)" << std::endl;
+  std::cout << "> instantiations: " << metrics.instantiations
+    << " (" << metrics.instantiate_ns << " ns)" << std::endl;
+  std::cout << "> guest calls: " << metrics.guest_calls << std::endl;
+  std::cout << "> host calls: " << metrics.host_calls << std::endl;
+  std::cout << "> live handles: " << metrics.live_handles << std::endl;
+  std::cout << "> external bytes: " << metrics.external_bytes << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("metrics.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  auto initial = store->metrics();
+  check(initial.compilations, 0u);
+  check(initial.guest_calls, 0u);
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Failed compilations are not counted.
+  binary[0] = 0;
+  check(wasm::Module::make(store, binary) == nullptr, true);
+  check(store->metrics().compilations, 1u);
+
+  // Create external function.
+  std::cout << "Creating callback..." << std::endl;
+  auto host_type = wasm::FuncType::make();
+  auto host_func = wasm::Func::make(store, host_type.get(), host_callback);
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting export..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto run_func = exports[0]->func();
+
+  // Call.
+  std::cout << "Calling export..." << std::endl;
+  for (int32_t i = 0; i < 3; ++i) {
+    auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(i));
+    auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+    if (run_func->call(args, results)) {
+      std::cout << "> Error calling function!" << std::endl;
+      exit(1);
+    }
+  }
+
+  // Print metrics.
+  std::cout << "Printing metrics..." << std::endl;
+  auto metrics = store->metrics();
+  print_metrics(metrics);
+  check(metrics.compilations, 1u);
+  check(metrics.instantiations, 1u);
+  check(metrics.guest_calls, 3u);
+  check(metrics.host_calls, 3u);
+  check(histogram_count(metrics.guest_call_ns), metrics.guest_calls);
+  check(histogram_count(metrics.host_call_ns), metrics.host_calls);
+  check(metrics.live_handles > 0, true);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,7 @@
+(module
+  (func $host (import "" "host"))
+  (func (export "run") (param i32) (result i32)
+    (call $host)
+    (i32.mul (local.get 0) (local.get 0))
+  )
+)
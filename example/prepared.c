@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("prepared.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  // Extract export.
+  printf("Extracting export...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size == 0) {
+    printf("> Error accessing exports!\n");
+    return 1;
+  }
+  const wasm_func_t* div_func = wasm_extern_as_func(exports.data[0]);
+  if (div_func == NULL) {
+    printf("> Error accessing export!\n");
+    return 1;
+  }
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Prepare.
+  printf("Preparing call...\n");
+  own wasm_func_prepared_t* prepared = wasm_func_prepare(div_func);
+  if (!prepared ||
+      wasm_func_prepared_param_arity(prepared) != 2 ||
+      wasm_func_prepared_result_arity(prepared) != 1) {
+    printf("> Error preparing call!\n");
+    return 1;
+  }
+
+  // Call repeatedly.
+  printf("Calling prepared...\n");
+  for (int32_t i = 1; i <= 4; ++i) {
+    wasm_val_t args[2] = { WASM_I32_VAL(100), WASM_I32_VAL(i) };
+    wasm_val_t results[1] = { WASM_INIT_VAL };
+    if (wasm_func_prepared_call_array(prepared, args, results)) {
+      printf("> Error calling function!\n");
+      return 1;
+    }
+    printf("> 100 / %d = %d\n", i, results[0].of.i32);
+    if (results[0].of.i32 != 100 / i) {
+      printf("> Error on result!\n");
+      return 1;
+    }
+  }
+
+  // Call in batches; the row dividing by zero traps on its own.
+  wasm_val_t args[8] = {
+    WASM_I32_VAL(12), WASM_I32_VAL(3),
+    WASM_I32_VAL(12), WASM_I32_VAL(0),
+    WASM_I32_VAL(-12), WASM_I32_VAL(4),
+    WASM_I32_VAL(7), WASM_I32_VAL(2),
+  };
+  int32_t expected[4] = { 4, 0, -3, 3 };
+  wasm_val_t results[4];
+  own wasm_trap_t* traps[4];
+
+  printf("Calling batch...\n");
+  if (wasm_func_call_batch(div_func, 4, args, results, traps) != 1) {
+    printf("> Error calling batch, expected one trap!\n");
+    return 1;
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    if (i == 1) {
+      if (!traps[i]) {
+        printf("> Error in row %zu, expected trap!\n", i);
+        return 1;
+      }
+      own wasm_message_t message;
+      wasm_trap_message(traps[i], &message);
+      printf("> row %zu: %s\n", i, message.data);
+      wasm_byte_vec_delete(&message);
+      wasm_trap_delete(traps[i]);
+    } else {
+      if (traps[i] || results[i].of.i32 != expected[i]) {
+        printf("> Error in row %zu!\n", i);
+        return 1;
+      }
+      printf("> row %zu: %d\n", i, results[i].of.i32);
+    }
+  }
+
+  printf("Calling prepared batch...\n");
+  if (wasm_func_prepared_call_batch(prepared, 4, args, results, NULL) != 1) {
+    printf("> Error calling batch, expected one trap!\n");
+    return 1;
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    if (i != 1 && results[i].of.i32 != expected[i]) {
+      printf("> Error in row %zu!\n", i);
+      return 1;
+    }
+  }
+
+  wasm_func_prepared_delete(prepared);
+  wasm_extern_vec_delete(&exports);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
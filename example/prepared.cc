@@ -0,0 +1,152 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+template<class T, class U>
+void check(T actual, U expected) {
+  if (actual != expected) {
+    std::cout << "> Error on result, expected " << expected << ", got " << actual << std::endl;
+    exit(1);
+  }
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("prepared.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting export..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto div_func = exports[0]->func();
+
+  // Prepare.
+  std::cout << "Preparing call..." << std::endl;
+  auto prepared = div_func->prepare();
+  if (!prepared) {
+    std::cout << "> Error preparing call!" << std::endl;
+    exit(1);
+  }
+  check(prepared->param_arity(), 2u);
+  check(prepared->result_arity(), 1u);
+
+  // Call repeatedly.
+  std::cout << "Calling prepared..." << std::endl;
+  for (int32_t i = 1; i <= 4; ++i) {
+    wasm::Val args[] = {wasm::Val::i32(100), wasm::Val::i32(i)};
+    wasm::Val results[1];
+    if (prepared->call(args, results)) {
+      std::cout << "> Error calling function!" << std::endl;
+      exit(1);
+    }
+    std::cout << "> 100 / " << i << " = " << results[0].i32() << std::endl;
+    check(results[0].i32(), 100 / i);
+  }
+
+  // Trap in a prepared call.
+  {
+    wasm::Val args[] = {wasm::Val::i32(1), wasm::Val::i32(0)};
+    wasm::Val results[1];
+    auto trap = prepared->call(args, results);
+    if (!trap) {
+      std::cout << "> Error calling function, expected trap!" << std::endl;
+      exit(1);
+    }
+    std::cout << "> " << trap->message().get() << std::endl;
+  }
+
+  // Call in batches; the row dividing by zero traps on its own.
+  const size_t n = 4;
+  wasm::Val args[2 * n] = {
+    wasm::Val::i32(12), wasm::Val::i32(3),
+    wasm::Val::i32(12), wasm::Val::i32(0),
+    wasm::Val::i32(-12), wasm::Val::i32(4),
+    wasm::Val::i32(7), wasm::Val::i32(2),
+  };
+  int32_t expected[n] = {4, 0, -3, 3};
+
+  std::cout << "Calling batch..." << std::endl;
+  {
+    wasm::Val results[n];
+    wasm::own<wasm::Trap> traps[n];
+    check(div_func->call_batch(n, args, results, traps), 1u);
+    for (size_t i = 0; i < n; ++i) {
+      if (i == 1) {
+        if (!traps[i]) {
+          std::cout << "> Error in row " << i << ", expected trap!" << std::endl;
+          exit(1);
+        }
+        std::cout << "> row " << i << ": " << traps[i]->message().get() << std::endl;
+      } else {
+        if (traps[i]) {
+          std::cout << "> Error in row " << i << ", unexpected trap!" << std::endl;
+          exit(1);
+        }
+        std::cout << "> row " << i << ": " << results[i].i32() << std::endl;
+        check(results[i].i32(), expected[i]);
+      }
+    }
+  }
+
+  std::cout << "Calling prepared batch..." << std::endl;
+  {
+    wasm::Val results[n];
+    check(prepared->call_batch(n, args, results), 1u);
+    for (size_t i = 0; i < n; ++i) {
+      if (i != 1) check(results[i].i32(), expected[i]);
+    }
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+void check(bool success) {
+  if (! success) {
+    std::cout << "> Error, expected success" << std::endl;
+    exit(1);
+  }
+}
+
+void check_range(
+  const wasm::Table* table, size_t index, size_t n, const wasm::Ref* expected
+) {
+  auto refs = wasm::ownvec<wasm::Ref>::make_uninitialized(n);
+  check(table->get_range(index, refs));
+  for (size_t i = 0; i < n; ++i) {
+    check(expected ? refs[i] && refs[i]->same(expected) : !refs[i]);
+  }
+}
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("range.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract exports.
+  std::cout << "Extracting exports..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() < 2 || !exports[0]->table() || !exports[1]->func()) {
+    std::cout << "> Error accessing exports!" << std::endl;
+    exit(1);
+  }
+  auto funcs = exports[0]->table();
+  auto f = exports[1]->func();
+
+  // Create anyref table.
+  std::cout << "Creating anyref table..." << std::endl;
+  auto tabletype = wasm::TableType::make(
+    wasm::ValType::make(wasm::ValKind::ANYREF), wasm::Limits(4, 4));
+  auto table = wasm::Table::make(store, tabletype.get());
+  if (!table) {
+    std::cout << "> Error creating table!" << std::endl;
+    exit(1);
+  }
+  auto foreign = wasm::Foreign::make(store);
+
+  // Fill.
+  std::cout << "Filling table..." << std::endl;
+  check(table->fill(0, 4, foreign.get()));
+  check_range(table.get(), 0, 4, foreign.get());
+  check(table->fill(1, 2));
+  check_range(table.get(), 1, 2, nullptr);
+  check_range(table.get(), 3, 1, foreign.get());
+  check(! table->fill(3, 2, f));
+  check_range(table.get(), 3, 1, foreign.get());
+
+  // Set ranges.
+  std::cout << "Setting ranges..." << std::endl;
+  const wasm::Ref* refs[] = {f, foreign.get()};
+  check(table->set_range(1, 2, refs));
+  check_range(table.get(), 1, 1, f);
+  check_range(table.get(), 2, 1, foreign.get());
+  check(! table->set_range(3, 2, refs));
+  check_range(table.get(), 3, 1, foreign.get());
+
+  // A funcref table takes functions only, and a failed range has no effect.
+  check(funcs->set_range(0, 1, refs));
+  check(! funcs->set_range(0, 2, refs));
+  check_range(funcs, 0, 2, f);
+
+  // Copy ranges.
+  std::cout << "Copying ranges..." << std::endl;
+  check(table->fill(0, 4));
+  check(table->copy_range(1, funcs, 0, 2));
+  check_range(table.get(), 0, 1, nullptr);
+  check_range(table.get(), 1, 2, f);
+  check_range(table.get(), 3, 1, nullptr);
+  check(table->copy_range(0, table.get(), 1, 3));
+  check_range(table.get(), 0, 2, f);
+  check_range(table.get(), 2, 2, nullptr);
+  check(! table->copy_range(3, funcs, 0, 2));
+
+  // Copying a foreign object into a funcref table fails.
+  check(table->set(0, foreign.get()));
+  check(! funcs->copy_range(0, table.get(), 0, 2));
+  check_range(funcs, 0, 2, f);
+  check(funcs->copy_range(0, table.get(), 2, 2));
+  check_range(funcs, 0, 2, nullptr);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
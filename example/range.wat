@@ -0,0 +1,5 @@
+(module
+  (table (export "funcs") 2 funcref)
+  (func $f (export "f") (result i32) (i32.const 7))
+  (elem (i32.const 0) $f $f)
+)
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+template<class T, class U>
+void check(T actual, U expected) {
+  if (actual != expected) {
+    std::cout << "> Error on result, expected " << expected << ", got " << actual << std::endl;
+    exit(1);
+  }
+}
+
+struct Exports {
+  wasm::ownvec<wasm::Extern> externs;
+  wasm::Memory* memory;
+  wasm::Global* runs;
+  const wasm::Func* load;
+};
+
+auto get_exports(const wasm::Instance* instance) -> Exports {
+  auto externs = instance->exports();
+  if (externs.size() < 3 || !externs[0]->memory() ||
+      !externs[1]->global() || !externs[2]->func()) {
+    std::cout << "> Error accessing exports!" << std::endl;
+    exit(1);
+  }
+  auto memory = externs[0]->memory();
+  auto runs = externs[1]->global();
+  auto load = externs[2]->func();
+  return Exports{std::move(externs), memory, runs, load};
+}
+
+auto call(const wasm::Func* func, int32_t arg) -> int32_t {
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(arg));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (func->call(args, results)) {
+    std::cout << "> Error on result, expected return" << std::endl;
+    exit(1);
+  }
+  return results[0].i32();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("snapshot.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // The start function has run once.
+  std::cout << "Checking instance..." << std::endl;
+  auto exports = get_exports(instance.get());
+  check(exports.runs->get_i32(), 1);
+  check(call(exports.load, 100), 42);
+
+  // Change the state before taking the snapshot.
+  exports.runs->set_i32(5);
+  exports.memory->data()[200] = 7;
+
+  // Snapshot.
+  std::cout << "Taking snapshot..." << std::endl;
+  auto snapshot = instance->snapshot();
+  if (!snapshot) {
+    std::cout << "> Error taking snapshot!" << std::endl;
+    exit(1);
+  }
+
+  // Later changes to the original do not affect the snapshot.
+  exports.runs->set_i32(9);
+  exports.memory->data()[200] = 9;
+
+  // Instantiate from the snapshot in another store.
+  std::cout << "Instantiating snapshot..." << std::endl;
+  auto store2_ = wasm::Store::make(engine.get());
+  auto store2 = store2_.get();
+  wasm::own<wasm::Trap> trap;
+  auto instance2 = snapshot->instantiate(store2, imports, &trap);
+  auto instance3 = snapshot->instantiate(store2, imports, &trap);
+  if (!instance2 || !instance3 || trap) {
+    std::cout << "> Error instantiating snapshot!" << std::endl;
+    exit(1);
+  }
+
+  // State carries over, and the start function does not run again.
+  std::cout << "Checking restored instances..." << std::endl;
+  auto exports2 = get_exports(instance2.get());
+  auto exports3 = get_exports(instance3.get());
+  check(exports2.runs->get_i32(), 5);
+  check(call(exports2.load, 100), 42);
+  check(call(exports2.load, 200), 7);
+
+  // Restored instances share memory copy-on-write.
+  exports2.memory->data()[200] = 1;
+  exports2.runs->set_i32(1);
+  check(call(exports3.load, 200), 7);
+  check(exports3.runs->get_i32(), 5);
+  check(call(exports.load, 200), 9);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,10 @@
+(module
+  (memory (export "memory") 1)
+  (global $runs (export "runs") (mut i32) (i32.const 0))
+  (func $init
+    (global.set $runs (i32.add (global.get $runs) (i32.const 1)))
+    (i32.store8 (i32.const 100) (i32.const 42))
+  )
+  (func (export "load") (param i32) (result i32) (i32.load8_u (local.get 0)))
+  (start $init)
+)
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+
+own wasm_module_t* compile_streaming(
+  wasm_store_t* store, const wasm_byte_vec_t* binary, size_t size, size_t chunk
+) {
+  own wasm_module_streaming_t* streaming = wasm_module_new_streaming(store);
+  for (size_t i = 0; i < size; i += chunk) {
+    size_t n = size - i < chunk ? size - i : chunk;
+    wasm_module_streaming_feed(streaming, binary->data + i, n);
+  }
+  own wasm_module_t* module = wasm_module_streaming_finish(streaming);
+  wasm_module_streaming_delete(streaming);
+  return module;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("stream.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile in chunks.
+  printf("Streaming module...\n");
+  own wasm_module_t* module = compile_streaming(store, &binary, binary.size, 7);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  // Compile a truncated binary.
+  printf("Streaming truncated module...\n");
+  own wasm_module_t* truncated =
+    compile_streaming(store, &binary, binary.size - 3, 7);
+  if (truncated) {
+    printf("> Error compiling truncated module, expected failure!\n");
+    return 1;
+  }
+
+  // Abort halfway.
+  printf("Aborting stream...\n");
+  own wasm_module_streaming_t* streaming = wasm_module_new_streaming(store);
+  wasm_module_streaming_feed(streaming, binary.data, binary.size / 2);
+  wasm_module_streaming_abort(streaming);
+  own wasm_module_t* aborted = wasm_module_streaming_finish(streaming);
+  if (aborted) {
+    printf("> Error finishing aborted stream, expected failure!\n");
+    return 1;
+  }
+  wasm_module_streaming_delete(streaming);
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  // Extract export.
+  printf("Extracting export...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size == 0) {
+    printf("> Error accessing exports!\n");
+    return 1;
+  }
+  const wasm_func_t* fib_func = wasm_extern_as_func(exports.data[0]);
+  if (fib_func == NULL) {
+    printf("> Error accessing export!\n");
+    return 1;
+  }
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Call.
+  printf("Calling export...\n");
+  wasm_val_t as[1] = { WASM_I32_VAL(10) };
+  wasm_val_t rs[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(as);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(rs);
+  if (wasm_func_call(fib_func, &args, &results)) {
+    printf("> Error calling function!\n");
+    return 1;
+  }
+
+  wasm_extern_vec_delete(&exports);
+
+  // Print result.
+  printf("Printing result...\n");
+  printf("> %u\n", rs[0].of.i32);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
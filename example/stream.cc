@@ -0,0 +1,108 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+#include <algorithm>
+
+#include "wasm.hh"
+
+
+auto compile_streaming(
+  wasm::Store* store, const wasm::vec<byte_t>& binary, size_t size, size_t chunk
+) -> wasm::own<wasm::Module> {
+  auto streaming = wasm::Module::make_streaming(store);
+  for (size_t i = 0; i < size; i += chunk) {
+    streaming->feed(binary.get() + i, std::min(chunk, size - i));
+  }
+  return streaming->finish();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("stream.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile in chunks.
+  std::cout << "Streaming module..." << std::endl;
+  auto module = compile_streaming(store, binary, binary.size(), 7);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile a truncated binary.
+  std::cout << "Streaming truncated module..." << std::endl;
+  if (compile_streaming(store, binary, binary.size() - 3, 7)) {
+    std::cout << "> Error compiling truncated module, expected failure!" << std::endl;
+    exit(1);
+  }
+
+  // Abort halfway.
+  std::cout << "Aborting stream..." << std::endl;
+  auto streaming = wasm::Module::make_streaming(store);
+  streaming->feed(binary.get(), binary.size() / 2);
+  streaming->abort();
+  if (streaming->finish()) {
+    std::cout << "> Error finishing aborted stream, expected failure!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting export..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || exports[0]->kind() != wasm::ExternKind::FUNC || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto fib_func = exports[0]->func();
+
+  // Call.
+  std::cout << "Calling export..." << std::endl;
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(10));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (fib_func->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+
+  // Print result.
+  std::cout << "Printing result..." << std::endl;
+  std::cout << "> " << results[0].i32() << std::endl;
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+
+void print_frame(wasm_frame_t* frame) {
+  printf("> %p @ 0x%zx = %"PRIu32".0x%zx\n",
+    wasm_frame_instance(frame),
+    wasm_frame_module_offset(frame),
+    wasm_frame_func_index(frame),
+    wasm_frame_func_offset(frame)
+  );
+}
+
+// Calls a trapping function and checks the length of the trap's trace.
+int check_trace(const wasm_func_t* func, size_t min, size_t max) {
+  wasm_val_vec_t args = WASM_EMPTY_VEC;
+  wasm_val_vec_t results = WASM_EMPTY_VEC;
+  own wasm_trap_t* trap = wasm_func_call(func, &args, &results);
+  if (!trap) {
+    printf("> Error calling function, expected trap!\n");
+    return 0;
+  }
+
+  own wasm_frame_vec_t trace;
+  wasm_trap_trace(trap, &trace);
+  for (size_t i = 0; i < trace.size; ++i) {
+    print_frame(trace.data[i]);
+  }
+
+  int ok = trace.size >= min && trace.size <= max;
+  for (size_t i = 0; ok && i < trace.size && i < 3; ++i) {
+    ok = wasm_frame_func_index(trace.data[i]) == i;
+  }
+  own wasm_frame_t* origin = wasm_trap_origin(trap);
+  if (ok) ok = trace.size == 0 ? origin == NULL : origin != NULL;
+  if (!ok) printf("> Error on trace!\n");
+
+  if (origin) wasm_frame_delete(origin);
+  wasm_frame_vec_delete(&trace);
+  wasm_trap_delete(trap);
+  return ok;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("trace.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  // Extract export.
+  printf("Extracting export...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size == 0) {
+    printf("> Error accessing exports!\n");
+    return 1;
+  }
+  const wasm_func_t* run_func = wasm_extern_as_func(exports.data[0]);
+  if (run_func == NULL) {
+    printf("> Error accessing export!\n");
+    return 1;
+  }
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Trace with the default depth.
+  printf("Calling export...\n");
+  if (!check_trace(run_func, 3, 10)) return 1;
+
+  // Limit the depth.
+  printf("Calling export with trace depth 2...\n");
+  wasm_store_set_trace_depth(store, 2);
+  if (!check_trace(run_func, 2, 2)) return 1;
+
+  // Disable tracing.
+  printf("Calling export with tracing disabled...\n");
+  wasm_store_set_trace_depth(store, 0);
+  if (!check_trace(run_func, 0, 0)) return 1;
+
+  wasm_extern_vec_delete(&exports);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
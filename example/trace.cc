@@ -0,0 +1,129 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+void print_frame(const wasm::Frame* frame) {
+  std::cout << "> " << frame->instance();
+  std::cout << " @ 0x" << std::hex << frame->module_offset();
+  std::cout << " = " << frame->func_index();
+  std::cout << ".0x" << std::hex << frame->func_offset() << std::dec << std::endl;
+}
+
+auto call_trap(const wasm::Func* func) -> wasm::own<wasm::Trap> {
+  auto args = wasm::vec<wasm::Val>::make();
+  auto results = wasm::vec<wasm::Val>::make();
+  auto trap = func->call(args, results);
+  if (!trap) {
+    std::cout << "> Error calling function, expected trap!" << std::endl;
+    exit(1);
+  }
+  return trap;
+}
+
+void check_trace(
+  const wasm::Trap* trap, const wasm::Instance* instance, size_t min, size_t max
+) {
+  auto trace = trap->trace();
+  for (size_t i = 0; i < trace.size(); ++i) print_frame(trace[i].get());
+  if (trace.size() < min || trace.size() > max) {
+    std::cout << "> Error on trace, expected " << min << " to " << max
+      << " frames, got " << trace.size() << std::endl;
+    exit(1);
+  }
+  // The Wasm frames come first, innermost to outermost.
+  for (uint32_t i = 0; i < trace.size() && i < 3; ++i) {
+    if (trace[i]->func_index() != i || !trace[i]->instance()->same(instance)) {
+      std::cout << "> Error on trace frame " << i << "!" << std::endl;
+      exit(1);
+    }
+  }
+  auto origin = trap->origin();
+  if (trace.size() == 0 ? origin != nullptr :
+      !origin || origin->func_index() != trace[0]->func_index()) {
+    std::cout << "> Error on origin!" << std::endl;
+    exit(1);
+  }
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("trace.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting export..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto run_func = exports[0]->func();
+
+  // Trace with the default depth.
+  std::cout << "Calling export..." << std::endl;
+  auto trap = call_trap(run_func);
+  std::cout << "> " << trap->message().get() << std::endl;
+  std::cout << "Printing trace..." << std::endl;
+  check_trace(trap.get(), instance.get(), 3, 10);
+
+  // Limit the depth.
+  std::cout << "Calling export with trace depth 2..." << std::endl;
+  store->set_trace_depth(2);
+  trap = call_trap(run_func);
+  check_trace(trap.get(), instance.get(), 2, 2);
+
+  // Disable tracing.
+  std::cout << "Calling export with tracing disabled..." << std::endl;
+  store->set_trace_depth(0);
+  trap = call_trap(run_func);
+  check_trace(trap.get(), instance.get(), 0, 0);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,5 @@
+(module
+  (func $fail (unreachable))
+  (func $middle (call $fail))
+  (func (export "run") (call $middle))
+)
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// Functions to be called from Wasm code, with their native signatures.
+auto multiply(int64_t x, int64_t y) -> int64_t {
+  std::cout << "Calling back multiply..." << std::endl;
+  return x * y;
+}
+
+void print(int32_t x) {
+  std::cout << "Calling back print..." << std::endl;
+  std::cout << "> " << x << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("typed.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create typed callbacks, whose function types derive from their signatures.
+  std::cout << "Creating callbacks..." << std::endl;
+  auto mul_func = wasm::Func::make(store, &multiply);
+  auto log_func = wasm::Func::make(store, &print);
+  if (!mul_func || !log_func) {
+    std::cout << "> Error creating callbacks!" << std::endl;
+    exit(1);
+  }
+
+  auto mul_type = mul_func->type();
+  if (mul_type->params().size() != 2 || mul_type->results().size() != 1 ||
+      mul_type->params()[0]->kind() != wasm::ValKind::I64 ||
+      mul_type->results()[0]->kind() != wasm::ValKind::I64) {
+    std::cout << "> Error on callback type!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(mul_func.get(), log_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting export..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() == 0 || !exports[0]->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto run_func = exports[0]->func();
+
+  // Call.
+  std::cout << "Calling export..." << std::endl;
+  auto args = wasm::vec<wasm::Val>::make(
+    wasm::Val::i64(int64_t(1) << 40), wasm::Val::i64(-3));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (run_func->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+
+  // Print result.
+  std::cout << "Printing result..." << std::endl;
+  std::cout << "> " << results[0].i64() << std::endl;
+  if (results[0].i64() != -(int64_t(3) << 40)) {
+    std::cout << "> Error on result!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
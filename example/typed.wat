@@ -0,0 +1,8 @@
+(module
+  (func $mul (import "" "mul") (param i64 i64) (result i64))
+  (func $log (import "" "log") (param i32))
+  (func (export "run") (param i64 i64) (result i64)
+    (call $log (i32.const 1))
+    (call $mul (local.get 0) (local.get 1))
+  )
+)
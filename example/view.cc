@@ -0,0 +1,181 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+template<class T, class U>
+void check(T actual, U expected) {
+  if (actual != expected) {
+    std::cout << "> Error on result, expected " << expected << ", got " << actual << std::endl;
+    exit(1);
+  }
+}
+
+void check(bool success) {
+  if (! success) {
+    std::cout << "> Error, expected success" << std::endl;
+    exit(1);
+  }
+}
+
+auto call(const wasm::Func* func, int32_t arg) -> int32_t {
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(arg));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (func->call(args, results)) {
+    std::cout << "> Error on result, expected return" << std::endl;
+    exit(1);
+  }
+  return results[0].i32();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("view.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract exports.
+  std::cout << "Extracting exports..." << std::endl;
+  auto exports = instance->exports();
+  if (exports.size() < 3 || !exports[0]->memory() ||
+      !exports[1]->func() || !exports[2]->func()) {
+    std::cout << "> Error accessing exports!" << std::endl;
+    exit(1);
+  }
+  auto memory = exports[0]->memory();
+  auto grow_func = exports[1]->func();
+  auto load_func = exports[2]->func();
+
+  // Read and write through a view.
+  std::cout << "Accessing view..." << std::endl;
+  auto view = memory->view();
+  check(view->memory()->same(memory));
+  check(view->data_size(), wasm::Memory::page_size);
+
+  const byte_t hello[] = "hello";
+  byte_t buffer[8] = {};
+  check(view->write(0x1000, hello, 5));
+  check(view->read(0x1000, buffer, 5));
+  check(std::memcmp(buffer, hello, 5) == 0);
+  check(call(load_func, 0x1000), 'h');
+  check(! view->write(0x10000 - 2, hello, 5));
+  check(! view->read(0x10000 - 2, buffer, 5));
+
+  check(view->fill(0x2000, 0x2a, 16));
+  check(call(load_func, 0x2000), 0x2a);
+  check(call(load_func, 0x200f), 0x2a);
+  check(call(load_func, 0x2010), 0);
+  check(! view->fill(0x10000 - 8, 0x2a, 16));
+  check(call(load_func, 0x10000 - 8), 0);
+
+  // Scatter and gather segments.
+  std::cout << "Scattering and gathering..." << std::endl;
+  byte_t abc[] = {'a', 'b', 'c'};
+  byte_t xyz[] = {'x', 'y', 'z'};
+  wasm::Memory::View::Segment out[] = {{0x3000, 3, abc}, {0x4000, 3, xyz}};
+  check(view->scatter(out, 2));
+  check(call(load_func, 0x3002), 'c');
+  check(call(load_func, 0x4000), 'x');
+
+  byte_t first[3] = {}, second[3] = {};
+  wasm::Memory::View::Segment in[] = {{0x4000, 3, first}, {0x3000, 3, second}};
+  check(view->gather(in, 2));
+  check(std::memcmp(first, xyz, 3) == 0);
+  check(std::memcmp(second, abc, 3) == 0);
+
+  wasm::Memory::View::Segment bad[] = {{0x5000, 3, abc}, {0x10000 - 1, 3, xyz}};
+  check(! view->scatter(bad, 2));
+  check(call(load_func, 0x5000), 0);
+
+  // Growing from Wasm refreshes the view.
+  std::cout << "Growing memory..." << std::endl;
+  check(call(grow_func, 1), 1);
+  check(view->data_size(), 2 * wasm::Memory::page_size);
+  check(view->write(0x18000, hello, 5));
+  check(call(load_func, 0x18004), 'o');
+  check(view->read(0x1000, buffer, 5));
+  check(std::memcmp(buffer, hello, 5) == 0);
+
+  // Create an image.
+  std::cout << "Creating image..." << std::endl;
+  auto pattern = wasm::vec<byte_t>::make_uninitialized(wasm::Memory::page_size);
+  for (size_t i = 0; i < pattern.size(); ++i) pattern[i] = byte_t(i % 251);
+  auto image = wasm::Memory::Image::make(pattern.get(), pattern.size());
+  if (!image) {
+    std::cout << "> Error creating image!" << std::endl;
+    exit(1);
+  }
+  check(image->size(), wasm::Memory::page_size);
+
+  // Create memories from it, which are copy-on-write.
+  std::cout << "Creating memories from image..." << std::endl;
+  auto memorytype = wasm::MemoryType::make(wasm::Limits(2));
+  auto memory1 = wasm::Memory::make(store, memorytype.get(), image.get());
+  auto memory2 = wasm::Memory::make(store, memorytype.get(), image.get());
+  if (!memory1 || !memory2) {
+    std::cout << "> Error creating memories!" << std::endl;
+    exit(1);
+  }
+  check(memory1->size(), 2u);
+  check(std::memcmp(memory1->data(), pattern.get(), pattern.size()) == 0);
+  check(memory1->data()[wasm::Memory::page_size], 0);
+  memory1->data()[0] = 0x7f;
+  check(memory2->data()[0], 0);
+
+  // Map it into the exported memory.
+  std::cout << "Mapping image..." << std::endl;
+  check(memory->map(wasm::Memory::page_size, image.get()));
+  check(call(load_func, 0x10000 + 250), 250);
+  check(call(load_func, 0x10000 + 251), 0);
+  check(call(load_func, 0x1000), 'h');
+  check(! memory->map(1, image.get()));
+  check(! memory->map(2 * wasm::Memory::page_size, image.get()));
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
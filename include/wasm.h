@@ -128,6 +128,35 @@ WASM_API_EXTERN own wasm_config_t* wasm_config_new(void);
 
 // Embedders may provide custom functions for manipulating configs.
 
+WASM_API_EXTERN void wasm_config_set_code_cache(
+  wasm_config_t*, const char* dir, size_t max_size);
+WASM_API_EXTERN void wasm_config_set_module_cache(wasm_config_t*, size_t max_size);
+
+typedef uint8_t wasm_tiering_t;
+enum wasm_tiering_enum {
+  WASM_TIERING_BASELINE,
+  WASM_TIERING_OPTIMIZING,
+  WASM_TIERING_TIERED,
+};
+
+WASM_API_EXTERN void wasm_config_set_tiering(wasm_config_t*, wasm_tiering_t);
+WASM_API_EXTERN void wasm_config_set_lazy_compilation(wasm_config_t*, bool);
+WASM_API_EXTERN void wasm_config_set_compilation_threads(wasm_config_t*, size_t);
+WASM_API_EXTERN void wasm_config_set_max_code_space(wasm_config_t*, size_t);
+WASM_API_EXTERN void wasm_config_set_memory_pool(wasm_config_t*, size_t);
+WASM_API_EXTERN void wasm_config_set_store_pool(wasm_config_t*, size_t);
+WASM_API_EXTERN void wasm_config_set_heap_limits(
+  wasm_config_t*, size_t max_old_size, size_t max_young_size);
+
+typedef uint8_t wasm_perf_profiling_t;
+enum wasm_perf_profiling_enum {
+  WASM_PERF_PROFILING_NONE,
+  WASM_PERF_PROFILING_PERF_MAP,
+  WASM_PERF_PROFILING_JITDUMP,
+};
+
+WASM_API_EXTERN void wasm_config_set_perf_profiling(wasm_config_t*, wasm_perf_profiling_t);
+
 
 // Engine
 
@@ -143,6 +172,49 @@ WASM_DECLARE_OWN(store)
 
 WASM_API_EXTERN own wasm_store_t* wasm_store_new(wasm_engine_t*);
 
+WASM_API_EXTERN size_t wasm_store_poll(wasm_store_t*, bool wait);
+
+// Interrupts running Wasm code from any thread; the call returns a trap.
+WASM_API_EXTERN void wasm_store_interrupt(wasm_store_t*);
+WASM_API_EXTERN void wasm_store_set_timeout(wasm_store_t*, uint32_t ms);
+
+typedef uint8_t wasm_collection_t;
+enum wasm_collection_enum {
+  WASM_COLLECTION_MINOR,
+  WASM_COLLECTION_FULL,
+};
+
+WASM_API_EXTERN void wasm_store_collect_garbage(wasm_store_t*, wasm_collection_t);
+WASM_API_EXTERN bool wasm_store_notify_idle(wasm_store_t*, uint32_t ms);
+
+typedef size_t (*wasm_heap_limit_callback_t)(
+  void* env, size_t current_limit, size_t initial_limit);
+
+WASM_API_EXTERN void wasm_store_set_heap_limit_callback(
+  wasm_store_t*, wasm_heap_limit_callback_t, void* env);
+
+WASM_API_EXTERN void wasm_store_set_trace_depth(wasm_store_t*, uint32_t depth);
+
+// Latency histograms count nanoseconds, bucket i holding [2^i, 2^(i+1)).
+#define WASM_METRICS_HISTOGRAM_SIZE 32
+
+typedef struct wasm_store_metrics_t {
+  uint64_t guest_calls;
+  uint64_t host_calls;
+  uint64_t guest_call_ns[WASM_METRICS_HISTOGRAM_SIZE];
+  uint64_t host_call_ns[WASM_METRICS_HISTOGRAM_SIZE];
+  uint64_t compilations;
+  uint64_t compile_ns;
+  uint64_t deserializations;
+  uint64_t deserialize_ns;
+  uint64_t instantiations;
+  uint64_t instantiate_ns;
+  size_t live_handles;
+  size_t external_bytes;
+} wasm_store_metrics_t;
+
+WASM_API_EXTERN void wasm_store_metrics(const wasm_store_t*, wasm_store_metrics_t* out);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -382,10 +454,23 @@ WASM_DECLARE_REF(trap)
 WASM_API_EXTERN own wasm_trap_t* wasm_trap_new(wasm_store_t* store, const wasm_message_t*);
 
 WASM_API_EXTERN void wasm_trap_message(const wasm_trap_t*, own wasm_message_t* out);
+WASM_API_EXTERN bool wasm_trap_interrupted(const wasm_trap_t*);
 WASM_API_EXTERN own wasm_frame_t* wasm_trap_origin(const wasm_trap_t*);
 WASM_API_EXTERN void wasm_trap_trace(const wasm_trap_t*, own wasm_frame_vec_t* out);
 
 
+// Profiles
+
+WASM_DECLARE_OWN(store_profile)
+
+WASM_API_EXTERN bool wasm_store_start_profiling(wasm_store_t*, uint32_t interval_us);
+WASM_API_EXTERN own wasm_store_profile_t* wasm_store_stop_profiling(wasm_store_t*);
+
+WASM_API_EXTERN size_t wasm_store_profile_samples(const wasm_store_profile_t*);
+WASM_API_EXTERN void wasm_store_profile_trace(
+  const wasm_store_profile_t*, size_t sample, own wasm_frame_vec_t* out);
+
+
 // Foreign Objects
 
 WASM_DECLARE_REF(foreign)
@@ -409,6 +494,27 @@ WASM_API_EXTERN void wasm_module_serialize(const wasm_module_t*, own wasm_byte_v
 WASM_API_EXTERN own wasm_module_t* wasm_module_deserialize(wasm_store_t*, const wasm_byte_vec_t*);
 
 
+// Streaming Compilation
+
+WASM_DECLARE_OWN(module_streaming)
+
+WASM_API_EXTERN own wasm_module_streaming_t* wasm_module_new_streaming(wasm_store_t*);
+
+WASM_API_EXTERN void wasm_module_streaming_feed(
+  wasm_module_streaming_t*, const wasm_byte_t* data, size_t size);
+WASM_API_EXTERN own wasm_module_t* wasm_module_streaming_finish(wasm_module_streaming_t*);
+WASM_API_EXTERN void wasm_module_streaming_abort(wasm_module_streaming_t*);
+
+
+// Asynchronous Compilation
+
+typedef void (*wasm_module_callback_t)(void* env, own wasm_module_t*);
+
+WASM_API_EXTERN void wasm_module_new_async(
+  wasm_store_t*, const wasm_byte_vec_t* binary,
+  wasm_module_callback_t, void* env);
+
+
 // Function Instances
 
 WASM_DECLARE_REF(func)
@@ -431,6 +537,38 @@ WASM_API_EXTERN size_t wasm_func_result_arity(const wasm_func_t*);
 WASM_API_EXTERN own wasm_trap_t* wasm_func_call(
   const wasm_func_t*, const wasm_val_vec_t* args, wasm_val_vec_t* results);
 
+// Calls the function n times over flat argument and result arrays, row by
+// row. Traps end only their own row and are stored in traps, if non-null.
+// Returns the number of rows that trapped.
+WASM_API_EXTERN size_t wasm_func_call_batch(
+  const wasm_func_t*, size_t n, const wasm_val_t args[], wasm_val_t results[],
+  own wasm_trap_t* traps[]);
+
+
+// Prepared Calls
+
+// A prepared call caches the function's signature and argument buffers,
+// so that repeated calls do not allocate. It is not thread-safe.
+
+WASM_DECLARE_OWN(func_prepared)
+
+WASM_API_EXTERN own wasm_func_prepared_t* wasm_func_prepare(const wasm_func_t*);
+
+WASM_API_EXTERN const wasm_func_t* wasm_func_prepared_func(const wasm_func_prepared_t*);
+WASM_API_EXTERN size_t wasm_func_prepared_param_arity(const wasm_func_prepared_t*);
+WASM_API_EXTERN size_t wasm_func_prepared_result_arity(const wasm_func_prepared_t*);
+
+WASM_API_EXTERN own wasm_trap_t* wasm_func_prepared_call(
+  wasm_func_prepared_t*, const wasm_val_vec_t* args, wasm_val_vec_t* results);
+
+// Takes plain arrays of param_arity arguments and result_arity results,
+// which are used in place.
+WASM_API_EXTERN own wasm_trap_t* wasm_func_prepared_call_array(
+  wasm_func_prepared_t*, const wasm_val_t args[], wasm_val_t results[]);
+WASM_API_EXTERN size_t wasm_func_prepared_call_batch(
+  wasm_func_prepared_t*, size_t n, const wasm_val_t args[], wasm_val_t results[],
+  own wasm_trap_t* traps[]);
+
 
 // Global Instances
 
@@ -444,6 +582,17 @@ WASM_API_EXTERN own wasm_globaltype_t* wasm_global_type(const wasm_global_t*);
 WASM_API_EXTERN void wasm_global_get(const wasm_global_t*, own wasm_val_t* out);
 WASM_API_EXTERN void wasm_global_set(wasm_global_t*, const wasm_val_t*);
 
+// Typed accessors for numeric globals of the given kind; they do not allocate.
+WASM_API_EXTERN wasm_valkind_t wasm_global_kind(const wasm_global_t*);
+WASM_API_EXTERN int32_t wasm_global_get_i32(const wasm_global_t*);
+WASM_API_EXTERN int64_t wasm_global_get_i64(const wasm_global_t*);
+WASM_API_EXTERN float32_t wasm_global_get_f32(const wasm_global_t*);
+WASM_API_EXTERN float64_t wasm_global_get_f64(const wasm_global_t*);
+WASM_API_EXTERN void wasm_global_set_i32(wasm_global_t*, int32_t);
+WASM_API_EXTERN void wasm_global_set_i64(wasm_global_t*, int64_t);
+WASM_API_EXTERN void wasm_global_set_f32(wasm_global_t*, float32_t);
+WASM_API_EXTERN void wasm_global_set_f64(wasm_global_t*, float64_t);
+
 
 // Table Instances
 
@@ -462,6 +611,18 @@ WASM_API_EXTERN bool wasm_table_set(wasm_table_t*, wasm_table_size_t index, wasm
 WASM_API_EXTERN wasm_table_size_t wasm_table_size(const wasm_table_t*);
 WASM_API_EXTERN bool wasm_table_grow(wasm_table_t*, wasm_table_size_t delta, wasm_ref_t* init);
 
+WASM_API_EXTERN bool wasm_table_fill(
+  wasm_table_t*, wasm_table_size_t index, wasm_table_size_t n, wasm_ref_t*);
+WASM_API_EXTERN bool wasm_table_copy_range(
+  wasm_table_t*, wasm_table_size_t index,
+  const wasm_table_t* src, wasm_table_size_t src_index, wasm_table_size_t n);
+WASM_API_EXTERN bool wasm_table_get_range(
+  const wasm_table_t*, wasm_table_size_t index, wasm_table_size_t n,
+  own wasm_ref_t* out[]);
+WASM_API_EXTERN bool wasm_table_set_range(
+  wasm_table_t*, wasm_table_size_t index, wasm_table_size_t n,
+  wasm_ref_t* const refs[]);
+
 
 // Memory Instances
 
@@ -482,6 +643,55 @@ WASM_API_EXTERN wasm_memory_pages_t wasm_memory_size(const wasm_memory_t*);
 WASM_API_EXTERN bool wasm_memory_grow(wasm_memory_t*, wasm_memory_pages_t delta);
 
 
+// Memory Views
+
+// A view caches a memory's base and size, refreshing them after the memory
+// may have grown. Bulk operations are bounds-checked as a whole.
+
+WASM_DECLARE_OWN(memory_view)
+
+typedef struct wasm_memory_segment_t {
+  size_t offset;
+  size_t size;
+  byte_t* data;
+} wasm_memory_segment_t;
+
+WASM_API_EXTERN own wasm_memory_view_t* wasm_memory_view_new(const wasm_memory_t*);
+
+WASM_API_EXTERN const wasm_memory_t* wasm_memory_view_memory(const wasm_memory_view_t*);
+WASM_API_EXTERN byte_t* wasm_memory_view_data(wasm_memory_view_t*);
+WASM_API_EXTERN size_t wasm_memory_view_data_size(wasm_memory_view_t*);
+
+WASM_API_EXTERN bool wasm_memory_view_read(
+  wasm_memory_view_t*, size_t offset, byte_t* dst, size_t size);
+WASM_API_EXTERN bool wasm_memory_view_write(
+  wasm_memory_view_t*, size_t offset, const byte_t* src, size_t size);
+WASM_API_EXTERN bool wasm_memory_view_fill(
+  wasm_memory_view_t*, size_t offset, byte_t value, size_t size);
+WASM_API_EXTERN bool wasm_memory_view_gather(
+  wasm_memory_view_t*, const wasm_memory_segment_t[], size_t n);
+WASM_API_EXTERN bool wasm_memory_view_scatter(
+  wasm_memory_view_t*, const wasm_memory_segment_t[], size_t n);
+
+
+// Memory Images
+
+// Immutable data that can be mapped copy-on-write into many memories.
+
+WASM_DECLARE_OWN(memory_image)
+
+WASM_API_EXTERN own wasm_memory_image_t* wasm_memory_image_new(const wasm_byte_vec_t* data);
+WASM_API_EXTERN own wasm_memory_image_t* wasm_memory_image_new_from_file(
+  int fd, size_t offset, size_t size);
+
+WASM_API_EXTERN size_t wasm_memory_image_size(const wasm_memory_image_t*);
+
+WASM_API_EXTERN own wasm_memory_t* wasm_memory_new_with_image(
+  wasm_store_t*, const wasm_memorytype_t*, const wasm_memory_image_t*);
+WASM_API_EXTERN bool wasm_memory_map(
+  wasm_memory_t*, size_t offset, const wasm_memory_image_t*);
+
+
 // Externals
 
 WASM_DECLARE_REF(extern)
@@ -521,6 +731,59 @@ WASM_API_EXTERN own wasm_instance_t* wasm_instance_new(
 );
 
 WASM_API_EXTERN void wasm_instance_exports(const wasm_instance_t*, own wasm_extern_vec_t* out);
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_index(
+  const wasm_instance_t*, size_t index);
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_name(
+  const wasm_instance_t*, const wasm_name_t* name);
+
+
+// Prepared Instantiation
+
+WASM_DECLARE_OWN(instance_prepared)
+
+WASM_API_EXTERN own wasm_instance_prepared_t* wasm_instance_prepare(
+  wasm_store_t*, const wasm_module_t*, const wasm_extern_vec_t* imports);
+
+WASM_API_EXTERN own wasm_instance_t* wasm_instance_prepared_instantiate(
+  const wasm_instance_prepared_t*, own wasm_trap_t**);
+
+
+// Instance Snapshots
+
+WASM_DECLARE_OWN(instance_snapshot)
+
+WASM_API_EXTERN own wasm_instance_snapshot_t* wasm_instance_snapshot(
+  const wasm_instance_t*);
+
+WASM_API_EXTERN own wasm_instance_t* wasm_instance_snapshot_instantiate(
+  const wasm_instance_snapshot_t*, wasm_store_t*,
+  const wasm_extern_vec_t* imports, own wasm_trap_t**);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Executors
+
+// Runs calls to a module's exports on a pool of worker threads, each with
+// its own store and instance. Arguments and results must be numeric.
+
+WASM_DECLARE_OWN(executor)
+
+typedef own wasm_instance_t* (*wasm_executor_setup_callback_t)(
+  void* env, wasm_store_t*, const wasm_module_t*);
+typedef void (*wasm_executor_callback_t)(
+  void* env, const wasm_val_vec_t* results, const wasm_message_t* trap);
+
+WASM_API_EXTERN own wasm_executor_t* wasm_executor_new(
+  wasm_engine_t*, const wasm_shared_module_t*, size_t threads,
+  wasm_executor_setup_callback_t, void* env);
+
+WASM_API_EXTERN size_t wasm_executor_threads(const wasm_executor_t*);
+
+// The callback runs on the worker thread; trap is null unless the call trapped.
+// Arguments are borrowed; reference arguments make the call trap.
+WASM_API_EXTERN void wasm_executor_submit(
+  wasm_executor_t*, size_t export_index, const wasm_val_vec_t* args,
+  wasm_executor_callback_t, void* env);
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <future>
 #include <memory>
 #include <limits>
 #include <string>
@@ -212,6 +213,51 @@ public:
   static auto make() -> own<Config>;
 
   // Implementations may provide custom methods for manipulating Configs.
+
+  // Cache compiled modules in the given directory, evicting the least
+  // recently used beyond max_size bytes (0 means unlimited).
+  void set_code_cache(const char* dir, size_t max_size = 0);
+
+  // Keep compiled modules in memory, keyed by their binary, so that making
+  // or validating a module from the same bytes in any store of the engine
+  // reuses its code. Least recently used modules are evicted beyond
+  // max_size bytes of code and binaries (0 means no cache).
+  void set_module_cache(size_t max_size);
+
+  // Compile with the baseline compiler only, the optimizing compiler only,
+  // or with the baseline compiler first and tier up hot functions.
+  enum class Tiering : uint8_t { BASELINE, OPTIMIZING, TIERED };
+  void set_tiering(Tiering);
+
+  // Compile functions on their first call instead of ahead of time.
+  void set_lazy_compilation(bool);
+
+  // Number of background compilation threads (0 means one per core).
+  void set_compilation_threads(size_t);
+
+  // Limit on code space committed by all modules in the process, in bytes,
+  // rounded up to whole megabytes (0 means default).
+  void set_max_code_space(size_t);
+
+  // Keep up to the given number of freed linear memory reservations for
+  // reuse by later memories, instead of unmapping them (0 means none).
+  void set_memory_pool(size_t);
+
+  // Keep up to the given number of destroyed stores, reset, and hand them
+  // out again from Store::make, saving isolate creation (0 means none).
+  // Host info finalizers still run when a store is destroyed.
+  void set_store_pool(size_t);
+
+  // Limits on each store's heap, in bytes: the old generation, holding
+  // long-lived references, and the young generation, where new objects are
+  // allocated and collected by fast minor GCs (0 means default).
+  void set_heap_limits(size_t max_old_size, size_t max_young_size = 0);
+
+  // Describe compiled code to the Linux perf tool, either in a perf map
+  // (/tmp/perf-<pid>.map) or in a jitdump file (jit-<pid>.dump in the
+  // working directory, to be merged with perf inject --jit).
+  enum class PerfProfiling : uint8_t { NONE, PERF_MAP, JITDUMP };
+  void set_perf_profiling(PerfProfiling);
 };
 
 
@@ -242,6 +288,71 @@ protected:
 
 public:
   static auto make(Engine*) -> own<Store>;
+
+  // Delivers the results of finished asynchronous operations, optionally
+  // waiting for background work first, and returns the number still pending.
+  auto poll(bool wait = false) -> size_t;
+
+  // Interrupts the Wasm code currently running in the store; callable from
+  // any thread. The interrupted call returns a trap for which
+  // Trap::interrupted() holds, and the store remains usable.
+  void interrupt();
+
+  // Interrupts any call into Wasm that runs longer than the given number of
+  // milliseconds (0 means no timeout). Checked by an engine-wide timer.
+  void set_timeout(uint32_t ms);
+
+  // Garbage collection, to be scheduled between calls rather than left to
+  // happen at random points during one.
+  enum class Collection : uint8_t { MINOR, FULL };
+  void collect_garbage(Collection = Collection::FULL);
+
+  // Lets V8 do incremental GC work for up to the given number of
+  // milliseconds. Returns true if there is nothing left to do until more
+  // work has run in the store.
+  auto notify_idle(uint32_t ms) -> bool;
+
+  // Called when the old generation nears its limit; returns the new limit
+  // in bytes, or current_limit for none, in which case V8 aborts the process
+  // with out of memory if collection cannot free enough.
+  using heap_limit_callback =
+    auto (*)(void* env, size_t current_limit, size_t initial_limit) -> size_t;
+  void set_heap_limit_callback(heap_limit_callback, void* env = nullptr);
+
+  // Maximum number of frames recorded for traps created in the store,
+  // including frames that are not Wasm (0 disables tracing, default 10).
+  // Traps record raw frames only; Trap::trace symbolizes them on demand.
+  void set_trace_depth(uint32_t depth);
+
+  // Runtime counters, always collected. A snapshot can be taken from any
+  // thread. Latency histograms count durations in nanoseconds, bucket i
+  // holding those in [2^i, 2^(i+1)), with the last bucket open-ended.
+  // Compilations, deserializations, and instantiations count successes.
+  struct Metrics {
+    enum : size_t { histogram_size = 32 };
+    uint64_t guest_calls;  // calls from the host into Wasm
+    uint64_t host_calls;   // calls from Wasm into host functions
+    uint64_t guest_call_ns[histogram_size];
+    uint64_t host_call_ns[histogram_size];
+    uint64_t compilations;
+    uint64_t compile_ns;
+    uint64_t deserializations;  // including code cache hits
+    uint64_t deserialize_ns;
+    uint64_t instantiations;
+    uint64_t instantiate_ns;
+    size_t live_handles;    // references held by the host
+    size_t external_bytes;  // off-heap memory, as of the last call or growth
+  };
+
+  auto metrics() const -> Metrics;
+
+  // Samples the Wasm call stack about every interval_us microseconds while
+  // Wasm code runs in the store. Samples are taken at the next function
+  // entry or loop iteration, so time in host functions is not attributed.
+  // Returns false if profiling is already active.
+  class Profile;
+  auto start_profiling(uint32_t interval_us = 1000) -> bool;
+  auto stop_profiling() -> own<Profile>;  // null if not profiling
 };
 
 
@@ -623,11 +734,28 @@ public:
   auto copy() const -> own<Trap>;
 
   auto message() const -> Message;
+  auto interrupted() const -> bool;  // by Store::interrupt or a timeout
   auto origin() const -> own<Frame>;  // may be null
   auto trace() const -> ownvec<Frame>;  // may be empty, origin first
 };
 
 
+// Profiles
+
+class WASM_API_EXTERN Store::Profile {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Profile() = default;
+  ~Profile() = default;
+
+public:
+  auto samples() const -> size_t;
+  auto trace(size_t sample) const -> ownvec<Frame>;  // innermost first
+};
+
+
 // Modules
 
 template<class T> class WASM_API_EXTERN Shared;
@@ -653,6 +781,36 @@ public:
 
   auto serialize() const -> vec<byte_t>;
   static auto deserialize(Store*, const vec<byte_t>&) -> own<Module>;
+
+  class Streaming;
+  static auto make_streaming(Store*) -> own<Streaming>;
+
+  // Compiles on background threads and calls back from Store::poll,
+  // with null if compilation failed or the store was destroyed first.
+  using async_callback = void (*)(void* env, own<Module>&&);
+  static void make_async(
+    Store*, const vec<byte_t>& binary, async_callback, void* env = nullptr);
+};
+
+
+// Streaming Compilation
+
+// Accepts a module binary in chunks as they arrive, while function bodies
+// already compile in the background. Finishing blocks until the module is
+// compiled and returns null if compilation failed or was aborted.
+
+class WASM_API_EXTERN Module::Streaming {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Streaming() = default;
+  ~Streaming() = default;
+
+public:
+  void feed(const byte_t* data, size_t size);
+  auto finish() -> own<Module>;
+  void abort();
 };
 
 
@@ -731,10 +889,14 @@ protected:
 public:
   using callback = auto (*)(const vec<Val>&, vec<Val>&) -> own<Trap>;
   using callback_with_env = auto (*)(void*, const vec<Val>&, vec<Val>&) -> own<Trap>;
+  using array_callback_with_env = auto (*)(void*, const Val[], Val[]) -> own<Trap>;
 
   static auto make(Store*, const FuncType*, callback) -> own<Func>;
   static auto make(Store*, const FuncType*, callback_with_env,
     void*, void (*finalizer)(void*) = nullptr) -> own<Func>;
+  static auto make(Store*, const FuncType*, array_callback_with_env,
+    void*, void (*finalizer)(void*) = nullptr) -> own<Func>;
+  template<class Sig> inline static auto make(Store*, Sig*) -> own<Func>;
   auto copy() const -> own<Func>;
 
   auto type() const -> own<FuncType>;
@@ -742,8 +904,127 @@ public:
   auto result_arity() const -> size_t;
 
   auto call(const vec<Val>&, vec<Val>&) const -> own<Trap>;
+
+  // Calls the function n times. Row i takes its arguments from
+  // args[i * param_arity()] and stores its results at
+  // results[i * result_arity()]. A trap only ends its own row; it is stored
+  // in traps[i] if traps is non-null, which is null for rows that completed.
+  // Returns the number of rows that trapped.
+  auto call_batch(size_t n, const Val args[], Val results[],
+    own<Trap> traps[] = nullptr) const -> size_t;
+
+  class Prepared;
+  auto prepare() const -> own<Prepared>;
+};
+
+
+// Prepared Calls
+
+// A prepared call decodes the function's signature once and keeps its scratch
+// buffers, so that repeated calls do not allocate. It is not thread-safe.
+
+class WASM_API_EXTERN Func::Prepared {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Prepared() = default;
+  ~Prepared() = default;
+
+public:
+  auto func() const -> const Func*;
+  auto param_arity() const -> size_t;
+  auto result_arity() const -> size_t;
+
+  auto call(const vec<Val>&, vec<Val>&) -> own<Trap>;
+  auto call(const Val args[], Val results[]) -> own<Trap>;
+  auto call_batch(size_t n, const Val args[], Val results[],
+    own<Trap> traps[] = nullptr) -> size_t;
+};
+
+
+// Typed Host Functions
+
+// Func::make<R(Ps...)>(store, f) derives the function type from the native
+// signature of f and passes arguments and results unboxed. Parameter and
+// result types can be int32_t, int64_t, uint32_t, uint64_t, float32_t or
+// float64_t; the result type can also be void. Such functions cannot trap.
+
+template<class T> struct valkind_of;
+template<> struct valkind_of<int32_t> { static const ValKind value = ValKind::I32; };
+template<> struct valkind_of<int64_t> { static const ValKind value = ValKind::I64; };
+template<> struct valkind_of<uint32_t> { static const ValKind value = ValKind::I32; };
+template<> struct valkind_of<uint64_t> { static const ValKind value = ValKind::I64; };
+template<> struct valkind_of<float32_t> { static const ValKind value = ValKind::F32; };
+template<> struct valkind_of<float64_t> { static const ValKind value = ValKind::F64; };
+
+namespace detail {
+
+template<size_t... Is> struct index_seq {};
+template<size_t N, size_t... Is>
+struct make_index_seq : make_index_seq<N - 1, N - 1, Is...> {};
+template<size_t... Is>
+struct make_index_seq<0, Is...> { using type = index_seq<Is...>; };
+
+template<class R>
+struct typed_result {
+  static auto types() -> ownvec<ValType> {
+    return ownvec<ValType>::make(ValType::make(valkind_of<R>::value));
+  }
+
+  template<class F, class... As>
+  static void apply(Val results[], F f, As... args) {
+    results[0] = Val::make<R>(f(args...));
+  }
 };
 
+template<>
+struct typed_result<void> {
+  static auto types() -> ownvec<ValType> {
+    return ownvec<ValType>::make();
+  }
+
+  template<class F, class... As>
+  static void apply(Val[], F f, As... args) {
+    f(args...);
+  }
+};
+
+template<class Sig> struct typed_func;
+
+template<class R, class... Ps>
+struct typed_func<R(Ps...)> {
+  static auto type() -> own<FuncType> {
+    return FuncType::make(
+      ownvec<ValType>::make(ValType::make(valkind_of<Ps>::value)...),
+      typed_result<R>::types());
+  }
+
+  template<size_t... Is>
+  static void invoke(
+    R (*f)(Ps...), const Val args[], Val results[], index_seq<Is...>
+  ) {
+    typed_result<R>::apply(results, f, args[Is].get<Ps>()...);
+  }
+
+  static auto callback(void* env, const Val args[], Val results[])
+    -> own<Trap> {
+    auto f = reinterpret_cast<R (*)(Ps...)>(env);
+    invoke(f, args, results, typename make_index_seq<sizeof...(Ps)>::type());
+    return nullptr;
+  }
+};
+
+}  // namespace detail
+
+template<class Sig>
+inline auto Func::make(Store* store, Sig* f) -> own<Func> {
+  using typed = detail::typed_func<Sig>;
+  auto type = typed::type();
+  if (!type) return own<Func>();
+  return make(store, type.get(), &typed::callback, reinterpret_cast<void*>(f));
+}
+
 
 // Global Instances
 
@@ -760,8 +1041,20 @@ protected:
   auto copy() const -> own<Global>;
 
   auto type() const -> own<GlobalType>;
+  auto kind() const -> ValKind;
   auto get() const -> Val;
   void set(const Val&);
+
+  // Typed accessors for numeric globals, which must be of the given kind.
+  // They do not allocate.
+  auto get_i32() const -> int32_t;
+  auto get_i64() const -> int64_t;
+  auto get_f32() const -> float32_t;
+  auto get_f64() const -> float64_t;
+  void set_i32(int32_t);
+  void set_i64(int64_t);
+  void set_f32(float32_t);
+  void set_f64(float64_t);
 };
 
 
@@ -787,6 +1080,16 @@ public:
   auto set(size_t index, const Ref*) -> bool;
   auto size() const -> size_t;
   auto grow(size_t delta, const Ref* init = nullptr) -> bool;
+
+  // Range operations fail without effect if the range is out of bounds or
+  // an element is not valid for the table. Copying handles overlap.
+  auto fill(size_t index, size_t n, const Ref* = nullptr) -> bool;
+  auto copy_range(size_t index, const Table* src, size_t src_index, size_t n)
+    -> bool;
+  auto get_range(size_t index, size_t n, own<Ref> refs[]) const -> bool;
+  auto get_range(size_t index, ownvec<Ref>& refs) const -> bool;
+  auto set_range(size_t index, size_t n, const Ref* const refs[]) -> bool;
+  auto set_range(size_t index, const vec<Ref*>& refs) -> bool;
 };
 
 
@@ -813,6 +1116,76 @@ public:
   auto data_size() const -> size_t;
   auto size() const -> pages_t;
   auto grow(pages_t delta) -> bool;
+
+  class View;
+  auto view() const -> own<View>;
+
+  class Image;
+  static auto make(Store*, const MemoryType*, const Image*) -> own<Memory>;
+  auto map(size_t offset, const Image*) -> bool;
+};
+
+
+// Memory Views
+
+// A view caches the base and size of a memory. Growing a memory, whether
+// through Memory::grow or from Wasm code, can move it, so the view refreshes
+// itself on first use after any call into Wasm, instantiation, or grow.
+// Bulk operations are bounds-checked as a whole and do nothing on failure.
+// A view is not thread-safe.
+
+class WASM_API_EXTERN Memory::View {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  View() = default;
+  ~View() = default;
+
+public:
+  struct Segment {
+    size_t offset;
+    size_t size;
+    byte_t* data;
+  };
+
+  auto memory() const -> const Memory*;
+  auto data() -> byte_t*;
+  auto data_size() -> size_t;
+
+  auto read(size_t offset, byte_t* dst, size_t size) -> bool;
+  auto write(size_t offset, const byte_t* src, size_t size) -> bool;
+  auto fill(size_t offset, byte_t value, size_t size) -> bool;
+
+  // Copy from memory into the segments' buffers, or from them into memory.
+  auto gather(const Segment[], size_t n) -> bool;
+  auto scatter(const Segment[], size_t n) -> bool;
+};
+
+
+// Memory Images
+
+// An image is immutable data that can be mapped copy-on-write into any
+// number of memories, across stores and threads, so that they share one
+// physical copy until written. Memory::map requires an offset aligned to
+// the system page size and fails if the image does not fit; if mapping
+// fails after that, the image's range is left reading as zero. Images made
+// from a file require a page-aligned file offset; the descriptor is
+// duplicated and can be closed by the caller.
+
+class WASM_API_EXTERN Memory::Image {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Image() = default;
+  ~Image() = default;
+
+public:
+  static auto make(const byte_t* data, size_t size) -> own<Image>;
+  static auto make_from_file(int fd, size_t offset, size_t size) -> own<Image>;
+
+  auto size() const -> size_t;
 };
 
 
@@ -833,6 +1206,101 @@ public:
   auto copy() const -> own<Instance>;
 
   auto exports() const -> ownvec<Extern>;
+  auto export_by_index(size_t index) const -> own<Extern>;
+  auto export_by_name(const Name& name) const -> own<Extern>;
+
+  class Prepared;
+  static auto prepare(
+    Store*, const Module*, const vec<Extern*>&
+  ) -> own<Prepared>;
+
+  class Snapshot;
+  auto snapshot() const -> own<Snapshot>;
+};
+
+
+// Prepared Instantiation
+
+// A prepared instantiation resolves a module's imports once, so that the
+// module can be instantiated repeatedly with the same imports.
+
+class WASM_API_EXTERN Instance::Prepared {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Prepared() = default;
+  ~Prepared() = default;
+
+public:
+  auto instantiate(own<Trap>* = nullptr) const -> own<Instance>;
+};
+
+
+// Instance Snapshots
+
+// A snapshot captures the state of an initialized instance: its own linear
+// memory, as an image mapped copy-on-write into every instance made from
+// it, its mutable numeric globals, and its tables' entries. Instances are
+// made from the snapshot's module without running the start function, in
+// any store and with any imports, which should match the original ones.
+// Imported memories, globals and tables are not captured, and table
+// entries other than the instance's own functions keep their initial value.
+
+class WASM_API_EXTERN Instance::Snapshot {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Snapshot() = default;
+  ~Snapshot() = default;
+
+public:
+  auto instantiate(
+    Store*, const vec<Extern*>&, own<Trap>* = nullptr
+  ) const -> own<Instance>;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Executors
+
+// An executor runs calls to a module's exports on a fixed pool of worker
+// threads. Each worker owns a store with its own instance of the module,
+// created by the setup callback, or instantiated without imports if none is
+// given. Calls are spread over the workers' queues, and idle workers steal
+// from busy ones. Arguments and results must be numeric, since references
+// cannot cross stores; calls to other exports, or with arguments that do not
+// match the parameter types, result in a trap without running.
+// Destroying an executor finishes all submitted calls.
+
+class WASM_API_EXTERN Executor {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Executor() = default;
+  ~Executor() = default;
+
+public:
+  using setup_callback = auto (*)(void*, Store*, const Module*) -> own<Instance>;
+  using callback = void (*)(void*, const vec<Val>& results, const Message* trap);
+
+  struct Result {
+    vec<Val> results = vec<Val>::invalid();
+    Message trap = Message::invalid();  // valid iff the call trapped
+  };
+
+  static auto make(
+    Engine*, const Shared<Module>*, size_t threads,
+    setup_callback = nullptr, void* env = nullptr
+  ) -> own<Executor>;
+
+  auto threads() const -> size_t;
+
+  auto submit(size_t export_index, vec<Val>&& args) -> std::future<Result>;
+  // The callback runs on the worker thread.
+  void submit(size_t export_index, vec<Val>&& args, callback, void* env);
 };
 
 
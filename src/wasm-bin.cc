@@ -161,30 +161,58 @@ auto wrapper(const GlobalType* type) -> vec<byte_t> {
 
 // Numbers
 
-auto u32(const byte_t*& pos) -> uint32_t {
-  uint32_t n = 0;
-  uint32_t shift = 0;
-  byte_t b;
-  do {
-    b = *pos++;
-    n += (b & 0x7f) << shift;
-    shift += 7;
-  } while ((b & 0x80) != 0);
-  return n;
-}
+// Most numbers in a binary fit into one or two bytes. Since a set
+// continuation bit guarantees that another byte follows, reading the second
+// byte is safe without knowing where the binary ends.
 
 auto u64(const byte_t*& pos) -> uint64_t {
+  auto b0 = static_cast<uint8_t>(pos[0]);
+  if (b0 < 0x80) { pos += 1; return b0; }
+  auto b1 = static_cast<uint8_t>(pos[1]);
+  if (b1 < 0x80) { pos += 2; return (b0 & 0x7f) | uint64_t(b1) << 7; }
   uint64_t n = 0;
   uint64_t shift = 0;
   byte_t b;
   do {
     b = *pos++;
-    n += (b & 0x7f) << shift;
+    n += uint64_t(b & 0x7f) << shift;
     shift += 7;
   } while ((b & 0x80) != 0);
   return n;
 }
 
+auto u32(const byte_t*& pos) -> uint32_t {
+  return static_cast<uint32_t>(bin::u64(pos));
+}
+
+// With at least 8 bytes left before end, a number of up to 8 bytes is
+// decoded from a single load: the first clear continuation bit gives its
+// length, and the 7-bit groups are compacted by shifts in three steps.
+auto u64(const byte_t*& pos, const byte_t* end) -> uint64_t {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (end - pos >= 8) {
+    uint64_t word;
+    std::memcpy(&word, pos, 8);
+    auto stops = ~word & 0x8080808080808080ull;
+    if (stops != 0) {
+      auto bits = __builtin_ctzll(stops) + 1;  // up to the last byte's msb
+      auto x = bits == 64 ? word : word & ((uint64_t(1) << bits) - 1);
+      x &= 0x7f7f7f7f7f7f7f7full;
+      x = ((x & 0x7f007f007f007f00ull) >> 1) | (x & 0x007f007f007f007full);
+      x = ((x & 0x3fff00003fff0000ull) >> 2) | (x & 0x00003fff00003fffull);
+      x = ((x & 0x0fffffff00000000ull) >> 4) | (x & 0x000000000fffffffull);
+      pos += bits / 8;
+      return x;
+    }
+  }
+#endif
+  return bin::u64(pos);
+}
+
+auto u32(const byte_t*& pos, const byte_t* end) -> uint32_t {
+  return static_cast<uint32_t>(bin::u64(pos, end));
+}
+
 void u32_skip(const byte_t*& pos) {
   bin::u32(pos);
 }
@@ -330,54 +358,56 @@ void expr_skip(const byte_t*& pos) {
 // Sections
 
 enum sec_t : byte_t {
+  SEC_CUSTOM = 0,
   SEC_TYPE = 1,
   SEC_IMPORT = 2,
   SEC_FUNC = 3,
   SEC_TABLE = 4,
   SEC_MEMORY = 5,
   SEC_GLOBAL = 6,
-  SEC_EXPORT = 7
+  SEC_EXPORT = 7,
+  SEC_START = 8,
+  SEC_COUNT = 13
 };
 
-auto section(const vec<byte_t>& binary, bin::sec_t sec) -> const byte_t* {
-  const byte_t* end = binary.get() + binary.size();
-  const byte_t* pos = binary.get() + 8;  // skip header
-  while (pos < end && *pos++ != sec) {
-    auto size = bin::u32(pos);
-    pos += size;
+// Section offsets, found in a single pass over the section headers.
+class sections {
+  const byte_t* begin_[SEC_COUNT] = {};
+  const byte_t* end_[SEC_COUNT] = {};
+
+public:
+  explicit sections(const vec<byte_t>& binary) {
+    const byte_t* end = binary.get() + binary.size();
+    const byte_t* pos = binary.get() + 8;  // skip header
+    while (pos < end) {
+      auto sec = static_cast<uint8_t>(*pos++);
+      auto size = bin::u32(pos, end);
+      if (sec != SEC_CUSTOM && sec < SEC_COUNT) {
+        begin_[sec] = pos;
+        end_[sec] = pos + size;
+      }
+      pos += size;
+    }
   }
-  if (pos == end) return nullptr;
-  bin::u32_skip(pos);
-  return pos;
-}
 
-auto section_end(const vec<byte_t>& binary, bin::sec_t sec) -> const byte_t* {
-  const byte_t* end = binary.get() + binary.size();
-  const byte_t* pos = binary.get() + 8;  // skip header
-  while (pos < end && *pos != sec) {
-    ++pos;
-    auto size = bin::u32(pos);
-    pos += size;
-  }
-  if (pos == end) return nullptr;
-  ++pos;
-  auto size = bin::u32(pos);
-  return pos + size;
-}
+  // Returns the section's contents, or null if it is absent.
+  auto begin(sec_t sec) const -> const byte_t* { return begin_[sec]; }
+  auto end(sec_t sec) const -> const byte_t* { return end_[sec]; }
+};
 
 
 // Type section
 
-auto types(const vec<byte_t>& binary) -> ownvec<FuncType> {
-  auto pos = bin::section(binary, SEC_TYPE);
+auto types(const sections& secs) -> ownvec<FuncType> {
+  auto pos = secs.begin(SEC_TYPE);
   if (pos == nullptr) return ownvec<FuncType>::make();
-  size_t size = bin::u32(pos);
+  size_t size = bin::u32(pos, secs.end(SEC_TYPE));
   // TODO(wasm+): support new deftypes
   auto v = ownvec<FuncType>::make_uninitialized(size);
   for (uint32_t i = 0; i < size; ++i) {
     v[i] = bin::functype(pos);
   }
-  assert(pos = bin::section_end(binary, SEC_TYPE));
+  assert(pos == secs.end(SEC_TYPE));
   return v;
 }
 
@@ -385,18 +415,19 @@ auto types(const vec<byte_t>& binary) -> ownvec<FuncType> {
 // Import section
 
 auto imports(
-  const vec<byte_t>& binary, const ownvec<FuncType>& types
+  const sections& secs, const ownvec<FuncType>& types
 ) -> ownvec<ImportType> {
-  auto pos = bin::section(binary, SEC_IMPORT);
+  auto pos = secs.begin(SEC_IMPORT);
   if (pos == nullptr) return ownvec<ImportType>::make();
-  size_t size = bin::u32(pos);
+  auto end = secs.end(SEC_IMPORT);
+  size_t size = bin::u32(pos, end);
   auto v = ownvec<ImportType>::make_uninitialized(size);
   for (uint32_t i = 0; i < size; ++i) {
     auto module = bin::name(pos);
     auto name = bin::name(pos);
     own<ExternType> type;
     switch (*pos++) {
-      case 0x00: type = types[bin::u32(pos)]->copy(); break;
+      case 0x00: type = types[bin::u32(pos, end)]->copy(); break;
       case 0x01: type = bin::tabletype(pos); break;
       case 0x02: type = bin::memorytype(pos); break;
       case 0x03: type = bin::globaltype(pos); break;
@@ -405,7 +436,7 @@ auto imports(
     v[i] = ImportType::make(
       std::move(module), std::move(name), std::move(type));
   }
-  assert(pos = bin::section_end(binary, SEC_IMPORT));
+  assert(pos == secs.end(SEC_IMPORT));
   return v;
 }
 
@@ -421,11 +452,12 @@ auto count(const ownvec<ImportType>& imports, ExternKind kind) -> uint32_t {
 // Function section
 
 auto funcs(
-  const vec<byte_t>& binary,
+  const sections& secs,
   const ownvec<ImportType>& imports, const ownvec<FuncType>& types
 ) -> ownvec<FuncType> {
-  auto pos = bin::section(binary, SEC_FUNC);
-  size_t size = pos != nullptr ? bin::u32(pos) : 0;
+  auto pos = secs.begin(SEC_FUNC);
+  auto end = secs.end(SEC_FUNC);
+  size_t size = pos != nullptr ? bin::u32(pos, end) : 0;
   auto v = ownvec<FuncType>::make_uninitialized(
     size + count(imports, ExternKind::FUNC));
   size_t j = 0;
@@ -437,9 +469,9 @@ auto funcs(
   }
   if (pos != nullptr) {
     for (; j < v.size(); ++j) {
-      v[j] = types[bin::u32(pos)]->copy();
+      v[j] = types[bin::u32(pos, end)]->copy();
     }
-    assert(pos = bin::section_end(binary, SEC_FUNC));
+    assert(pos == secs.end(SEC_FUNC));
   }
   return v;
 }
@@ -448,10 +480,11 @@ auto funcs(
 // Global section
 
 auto globals(
-  const vec<byte_t>& binary, const ownvec<ImportType>& imports
+  const sections& secs, const ownvec<ImportType>& imports
 ) -> ownvec<GlobalType> {
-  auto pos = bin::section(binary, SEC_GLOBAL);
-  size_t size = pos != nullptr ? bin::u32(pos) : 0;
+  auto pos = secs.begin(SEC_GLOBAL);
+  auto end = secs.end(SEC_GLOBAL);
+  size_t size = pos != nullptr ? bin::u32(pos, end) : 0;
   auto v = ownvec<GlobalType>::make_uninitialized(
     size + count(imports, ExternKind::GLOBAL));
   size_t j = 0;
@@ -466,7 +499,7 @@ auto globals(
       v[j] = bin::globaltype(pos);
       expr_skip(pos);
     }
-    assert(pos = bin::section_end(binary, SEC_GLOBAL));
+    assert(pos == secs.end(SEC_GLOBAL));
   }
   return v;
 }
@@ -475,10 +508,11 @@ auto globals(
 // Table section
 
 auto tables(
-  const vec<byte_t>& binary, const ownvec<ImportType>& imports
+  const sections& secs, const ownvec<ImportType>& imports
 ) -> ownvec<TableType> {
-  auto pos = bin::section(binary, SEC_TABLE);
-  size_t size = pos != nullptr ? bin::u32(pos) : 0;
+  auto pos = secs.begin(SEC_TABLE);
+  auto end = secs.end(SEC_TABLE);
+  size_t size = pos != nullptr ? bin::u32(pos, end) : 0;
   auto v = ownvec<TableType>::make_uninitialized(
     size + count(imports, ExternKind::TABLE));
   size_t j = 0;
@@ -492,7 +526,7 @@ auto tables(
     for (; j < v.size(); ++j) {
       v[j] = bin::tabletype(pos);
     }
-    assert(pos = bin::section_end(binary, SEC_TABLE));
+    assert(pos == secs.end(SEC_TABLE));
   }
   return v;
 }
@@ -501,10 +535,11 @@ auto tables(
 // Memory section
 
 auto memories(
-  const vec<byte_t>& binary, const ownvec<ImportType>& imports
+  const sections& secs, const ownvec<ImportType>& imports
 ) -> ownvec<MemoryType> {
-  auto pos = bin::section(binary, SEC_MEMORY);
-  size_t size = pos != nullptr ? bin::u32(pos) : 0;
+  auto pos = secs.begin(SEC_MEMORY);
+  auto end = secs.end(SEC_MEMORY);
+  size_t size = pos != nullptr ? bin::u32(pos, end) : 0;
   auto v = ownvec<MemoryType>::make_uninitialized(
     size + count(imports, ExternKind::MEMORY));
   size_t j = 0;
@@ -518,7 +553,7 @@ auto memories(
     for (; j < v.size(); ++j) {
       v[j] = bin::memorytype(pos);
     }
-    assert(pos = bin::section_end(binary, SEC_MEMORY));
+    assert(pos == secs.end(SEC_MEMORY));
   }
   return v;
 }
@@ -526,18 +561,19 @@ auto memories(
 
 // Export section
 
-auto exports(const vec<byte_t>& binary,
+auto exports(const sections& secs,
   const ownvec<FuncType>& funcs, const ownvec<GlobalType>& globals,
   const ownvec<TableType>& tables, const ownvec<MemoryType>& memories
 ) -> ownvec<ExportType> {
-  auto pos = bin::section(binary, SEC_EXPORT);
+  auto pos = secs.begin(SEC_EXPORT);
   if (pos == nullptr) return ownvec<ExportType>::make();
-  size_t size = bin::u32(pos);
+  auto end = secs.end(SEC_EXPORT);
+  size_t size = bin::u32(pos, end);
   auto exports = ownvec<ExportType>::make_uninitialized(size);
   for (uint32_t i = 0; i < size; ++i) {
     auto name = bin::name(pos);
     auto tag = *pos++;
-    auto index = bin::u32(pos);
+    auto index = bin::u32(pos, end);
     own<ExternType> type;
     switch (tag) {
       case 0x00: type = funcs[index]->copy(); break;
@@ -548,22 +584,75 @@ auto exports(const vec<byte_t>& binary,
     }
     exports[i] = ExportType::make(std::move(name), std::move(type));
   }
-  assert(pos = bin::section_end(binary, SEC_EXPORT));
+  assert(pos == secs.end(SEC_EXPORT));
   return exports;
 }
 
+// Start section
+
+// Returns a copy of the binary without the start section, or an invalid
+// vector if there is none.
+auto without_start(const vec<byte_t>& binary) -> vec<byte_t> {
+  sections secs(binary);
+  auto pos = secs.begin(SEC_START);
+  if (pos == nullptr) return vec<byte_t>::invalid();
+  // Back up over the section id and size.
+  auto start = pos - 1;
+  while (static_cast<uint8_t>(start[-1]) >= 0x80) --start;
+  --start;
+  auto end = secs.end(SEC_START);
+  auto head = start - binary.get();
+  auto tail = binary.get() + binary.size() - end;
+  auto result = vec<byte_t>::make_uninitialized(head + tail);
+  std::memcpy(result.get(), binary.get(), head);
+  std::memcpy(result.get() + head, end, tail);
+  return result;
+}
+
+
+// Modules
+
 auto imports(const vec<byte_t>& binary) -> ownvec<ImportType> {
-  return bin::imports(binary, bin::types(binary));
+  sections secs(binary);
+  return bin::imports(secs, bin::types(secs));
 }
 
 auto exports(const vec<byte_t>& binary) -> ownvec<ExportType> {
-  auto types = bin::types(binary);
-  auto imports = bin::imports(binary, types);
-  auto funcs = bin::funcs(binary, imports, types);
-  auto globals = bin::globals(binary, imports);
-  auto tables = bin::tables(binary, imports);
-  auto memories = bin::memories(binary, imports);
-  return bin::exports(binary, funcs, globals, tables, memories);
+  auto imports = ownvec<ImportType>::invalid();
+  auto exports = ownvec<ExportType>::invalid();
+  bin::externs(binary, imports, exports);
+  return exports;
+}
+
+void externs(const vec<byte_t>& binary,
+  ownvec<ImportType>& imports, ownvec<ExportType>& exports
+) {
+  sections secs(binary);
+  auto types = bin::types(secs);
+  imports = bin::imports(secs, types);
+  auto funcs = bin::funcs(secs, imports, types);
+  auto globals = bin::globals(secs, imports);
+  auto tables = bin::tables(secs, imports);
+  auto memories = bin::memories(secs, imports);
+  exports = bin::exports(secs, funcs, globals, tables, memories);
+}
+
+auto export_names(const vec<byte_t>& binary) -> std::vector<name_ref> {
+  sections secs(binary);
+  std::vector<name_ref> names;
+  auto pos = secs.begin(SEC_EXPORT);
+  if (pos == nullptr) return names;
+  auto end = secs.end(SEC_EXPORT);
+  names.resize(bin::u32(pos, end));
+  for (auto& name: names) {
+    name.size = bin::u32(pos, end);
+    name.data = pos;
+    pos += name.size;
+    ++pos;  // kind
+    bin::u32(pos, end);
+  }
+  assert(pos == end);
+  return names;
 }
 
 }  // namespace bin
@@ -3,6 +3,8 @@
 
 #include "wasm.hh"
 
+#include <vector>
+
 namespace wasm {
 namespace bin {
 
@@ -12,12 +14,26 @@ void encode_u32(char*& ptr, uint32_t n);
 void encode_u64(char*& ptr, uint64_t n);
 auto u32(const byte_t*& pos) -> uint32_t;
 auto u64(const byte_t*& pos) -> uint64_t;
+auto u32(const byte_t*& pos, const byte_t* end) -> uint32_t;
+auto u64(const byte_t*& pos, const byte_t* end) -> uint64_t;
 
 auto wrapper(const FuncType*) -> vec<byte_t>;
 auto wrapper(const GlobalType*) -> vec<byte_t>;
 
+auto without_start(const vec<byte_t>& binary) -> vec<byte_t>;
+
 auto imports(const vec<byte_t>& binary) -> ownvec<ImportType>;
 auto exports(const vec<byte_t>& binary) -> ownvec<ExportType>;
+void externs(const vec<byte_t>& binary,
+  ownvec<ImportType>& imports, ownvec<ExportType>& exports);
+
+// Export names in order, pointing into the binary.
+struct name_ref {
+  const byte_t* data;
+  size_t size;
+};
+
+auto export_names(const vec<byte_t>& binary) -> std::vector<name_ref>;
 
 }  // namespace bin
 }  // namespace wasm
@@ -28,10 +28,6 @@ struct borrowed_vec {
 #define WASM_DEFINE_OWN(name, Name) \
   struct wasm_##name##_t : Name {}; \
   \
-  void wasm_##name##_delete(wasm_##name##_t* x) { \
-    delete x; \
-  } \
-  \
   extern "C++" inline auto hide_##name(Name* x) -> wasm_##name##_t* { \
     return static_cast<wasm_##name##_t*>(x); \
   } \
@@ -54,7 +50,11 @@ struct borrowed_vec {
     return hide_##name(x.release()); \
   } \
   extern "C++" inline auto adopt_##name(wasm_##name##_t* x) -> own<Name> { \
-    return make_own(x); \
+    return make_own(static_cast<Name*>(x)); \
+  } \
+  \
+  void wasm_##name##_delete(wasm_##name##_t* x) { \
+    adopt_##name(x); \
   }
 
 
@@ -211,6 +211,52 @@ wasm_config_t* wasm_config_new() {
   return release_config(Config::make());
 }
 
+void wasm_config_set_code_cache(
+  wasm_config_t* config, const char* dir, size_t max_size
+) {
+  config->set_code_cache(dir, max_size);
+}
+
+void wasm_config_set_module_cache(wasm_config_t* config, size_t max_size) {
+  config->set_module_cache(max_size);
+}
+
+void wasm_config_set_tiering(wasm_config_t* config, wasm_tiering_t tiering) {
+  config->set_tiering(static_cast<Config::Tiering>(tiering));
+}
+
+void wasm_config_set_lazy_compilation(wasm_config_t* config, bool lazy) {
+  config->set_lazy_compilation(lazy);
+}
+
+void wasm_config_set_compilation_threads(wasm_config_t* config, size_t n) {
+  config->set_compilation_threads(n);
+}
+
+void wasm_config_set_max_code_space(wasm_config_t* config, size_t size) {
+  config->set_max_code_space(size);
+}
+
+void wasm_config_set_memory_pool(wasm_config_t* config, size_t max_pooled) {
+  config->set_memory_pool(max_pooled);
+}
+
+void wasm_config_set_store_pool(wasm_config_t* config, size_t max_pooled) {
+  config->set_store_pool(max_pooled);
+}
+
+void wasm_config_set_heap_limits(
+  wasm_config_t* config, size_t max_old_size, size_t max_young_size
+) {
+  config->set_heap_limits(max_old_size, max_young_size);
+}
+
+void wasm_config_set_perf_profiling(
+  wasm_config_t* config, wasm_perf_profiling_t profiling
+) {
+  config->set_perf_profiling(static_cast<Config::PerfProfiling>(profiling));
+}
+
 
 // Engine
 
@@ -233,6 +279,49 @@ wasm_store_t* wasm_store_new(wasm_engine_t* engine) {
   return release_store(Store::make(engine));
 };
 
+size_t wasm_store_poll(wasm_store_t* store, bool wait) {
+  return store->poll(wait);
+}
+
+void wasm_store_interrupt(wasm_store_t* store) {
+  store->interrupt();
+}
+
+void wasm_store_set_timeout(wasm_store_t* store, uint32_t ms) {
+  store->set_timeout(ms);
+}
+
+void wasm_store_collect_garbage(
+  wasm_store_t* store, wasm_collection_t collection
+) {
+  store->collect_garbage(static_cast<Store::Collection>(collection));
+}
+
+bool wasm_store_notify_idle(wasm_store_t* store, uint32_t ms) {
+  return store->notify_idle(ms);
+}
+
+void wasm_store_set_heap_limit_callback(
+  wasm_store_t* store, wasm_heap_limit_callback_t callback, void* env
+) {
+  store->set_heap_limit_callback(callback, env);
+}
+
+void wasm_store_set_trace_depth(wasm_store_t* store, uint32_t depth) {
+  store->set_trace_depth(depth);
+}
+
+static_assert(sizeof(wasm_store_metrics_t) == sizeof(Store::Metrics),
+  "C/C++ incompatibility");
+static_assert(
+  WASM_METRICS_HISTOGRAM_SIZE == Store::Metrics::histogram_size,
+  "C/C++ incompatibility");
+
+void wasm_store_metrics(const wasm_store_t* store, wasm_store_metrics_t* out) {
+  auto metrics = store->metrics();
+  std::memcpy(out, &metrics, sizeof(metrics));
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -706,6 +795,10 @@ void wasm_trap_message(const wasm_trap_t* trap, wasm_message_t* out) {
   *out = release_byte_vec(reveal_trap(trap)->message());
 }
 
+bool wasm_trap_interrupted(const wasm_trap_t* trap) {
+  return reveal_trap(trap)->interrupted();
+}
+
 wasm_frame_t* wasm_trap_origin(const wasm_trap_t* trap) {
   return release_frame(reveal_trap(trap)->origin());
 }
@@ -715,6 +808,29 @@ void wasm_trap_trace(const wasm_trap_t* trap, wasm_frame_vec_t* out) {
 }
 
 
+// Profiles
+
+WASM_DEFINE_OWN(store_profile, Store::Profile)
+
+bool wasm_store_start_profiling(wasm_store_t* store, uint32_t interval_us) {
+  return store->start_profiling(interval_us);
+}
+
+wasm_store_profile_t* wasm_store_stop_profiling(wasm_store_t* store) {
+  return release_store_profile(store->stop_profiling());
+}
+
+size_t wasm_store_profile_samples(const wasm_store_profile_t* profile) {
+  return profile->samples();
+}
+
+void wasm_store_profile_trace(
+  const wasm_store_profile_t* profile, size_t sample, wasm_frame_vec_t* out
+) {
+  *out = release_frame_vec(profile->trace(sample));
+}
+
+
 // Foreign Objects
 
 WASM_DEFINE_REF(foreign, Foreign)
@@ -773,30 +889,83 @@ wasm_module_t* wasm_module_obtain(wasm_store_t* store, const wasm_shared_module_
 }
 
 
+// Streaming Compilation
+
+WASM_DEFINE_OWN(module_streaming, Module::Streaming)
+
+wasm_module_streaming_t* wasm_module_new_streaming(wasm_store_t* store) {
+  return release_module_streaming(Module::make_streaming(store));
+}
+
+void wasm_module_streaming_feed(
+  wasm_module_streaming_t* streaming, const wasm_byte_t* data, size_t size
+) {
+  streaming->feed(data, size);
+}
+
+wasm_module_t* wasm_module_streaming_finish(wasm_module_streaming_t* streaming) {
+  return release_module(streaming->finish());
+}
+
+void wasm_module_streaming_abort(wasm_module_streaming_t* streaming) {
+  streaming->abort();
+}
+
+
+// Asynchronous Compilation
+
+extern "C++" {
+
+struct wasm_module_callback_env_t {
+  wasm_module_callback_t callback;
+  void* env;
+};
+
+void wasm_module_callback(void* env, own<Module>&& module) {
+  auto t = static_cast<wasm_module_callback_env_t*>(env);
+  t->callback(t->env, release_module(std::move(module)));
+  delete t;
+}
+
+}  // extern "C++"
+
+void wasm_module_new_async(
+  wasm_store_t* store, const wasm_byte_vec_t* binary,
+  wasm_module_callback_t callback, void* env
+) {
+  auto binary_ = borrow_byte_vec(binary);
+  auto env2 = new wasm_module_callback_env_t{callback, env};
+  Module::make_async(store, binary_.it, wasm_module_callback, env2);
+}
+
+
 // Function Instances
 
 WASM_DEFINE_REF(func, Func)
 
 extern "C++" {
 
-auto wasm_callback(
-  void* env, const vec<Val>& args, vec<Val>& results
-) -> own<Trap> {
-  auto f = reinterpret_cast<wasm_func_callback_t>(env);
-  return adopt_trap(f(hide_val_vec(args), hide_val_vec(results)));
-}
+// C callbacks go through the array callback path, which passes arguments and
+// results in stack buffers. Since wasm_val_t and Val share their layout,
+// the callback sees those buffers directly.
 
 struct wasm_callback_env_t {
-  wasm_func_callback_with_env_t callback;
+  wasm_func_callback_t callback;
+  wasm_func_callback_with_env_t callback_with_env;
   void* env;
   void (*finalizer)(void*);
+  size_t param_arity;
+  size_t result_arity;
 };
 
-auto wasm_callback_with_env(
-  void* env, const vec<Val>& args, vec<Val>& results
-) -> own<Trap> {
+auto wasm_callback(void* env, const Val args[], Val results[]) -> own<Trap> {
   auto t = static_cast<wasm_callback_env_t*>(env);
-  return adopt_trap(t->callback(t->env, hide_val_vec(args), hide_val_vec(results)));
+  const wasm_val_vec_t args_ = {
+    t->param_arity, const_cast<wasm_val_t*>(hide_val_vec(args))};
+  wasm_val_vec_t results_ = {t->result_arity, hide_val_vec(results)};
+  return adopt_trap(t->callback
+    ? t->callback(&args_, &results_)
+    : t->callback_with_env(t->env, &args_, &results_));
 }
 
 void wasm_callback_env_finalizer(void* env) {
@@ -811,16 +980,20 @@ wasm_func_t* wasm_func_new(
   wasm_store_t* store, const wasm_functype_t* type,
   wasm_func_callback_t callback
 ) {
+  auto env2 = new wasm_callback_env_t{callback, nullptr, nullptr, nullptr,
+    type->params().size(), type->results().size()};
   return release_func(Func::make(
-    store, type, wasm_callback, reinterpret_cast<void*>(callback)));
+    store, type, wasm_callback, env2, wasm_callback_env_finalizer));
 }
 
 wasm_func_t *wasm_func_new_with_env(
   wasm_store_t* store, const wasm_functype_t* type,
   wasm_func_callback_with_env_t callback, void *env, void (*finalizer)(void*)
 ) {
-  auto env2 = new wasm_callback_env_t{callback, env, finalizer};
-  return release_func(Func::make(store, type, wasm_callback_with_env, env2, wasm_callback_env_finalizer));
+  auto env2 = new wasm_callback_env_t{nullptr, callback, env, finalizer,
+    type->params().size(), type->results().size()};
+  return release_func(Func::make(
+    store, type, wasm_callback, env2, wasm_callback_env_finalizer));
 }
 
 wasm_functype_t* wasm_func_type(const wasm_func_t* func) {
@@ -843,6 +1016,69 @@ wasm_trap_t* wasm_func_call(
   return release_trap(func->call(args_.it, results_.it));
 }
 
+extern "C++" inline auto reveal_traps(
+  size_t n, wasm_trap_t* traps[]
+) -> own<Trap>* {
+  static_assert(sizeof(wasm_trap_t*) == sizeof(own<Trap>),
+    "C/C++ incompatibility");
+  if (!traps) return nullptr;
+  for (size_t i = 0; i < n; ++i) traps[i] = nullptr;
+  return reinterpret_cast<own<Trap>*>(traps);
+}
+
+size_t wasm_func_call_batch(
+  const wasm_func_t* func, size_t n,
+  const wasm_val_t args[], wasm_val_t results[], wasm_trap_t* traps[]
+) {
+  return func->call_batch(n, reveal_val_vec(args), reveal_val_vec(results),
+    reveal_traps(n, traps));
+}
+
+
+// Prepared Calls
+
+WASM_DEFINE_OWN(func_prepared, Func::Prepared)
+
+wasm_func_prepared_t* wasm_func_prepare(const wasm_func_t* func) {
+  return release_func_prepared(func->prepare());
+}
+
+const wasm_func_t* wasm_func_prepared_func(const wasm_func_prepared_t* prepared) {
+  return hide_func(prepared->func());
+}
+
+size_t wasm_func_prepared_param_arity(const wasm_func_prepared_t* prepared) {
+  return prepared->param_arity();
+}
+
+size_t wasm_func_prepared_result_arity(const wasm_func_prepared_t* prepared) {
+  return prepared->result_arity();
+}
+
+wasm_trap_t* wasm_func_prepared_call(
+  wasm_func_prepared_t* prepared,
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  auto args_ = borrow_val_vec(args);
+  auto results_ = borrow_val_vec(results);
+  return release_trap(prepared->call(args_.it, results_.it));
+}
+
+wasm_trap_t* wasm_func_prepared_call_array(
+  wasm_func_prepared_t* prepared, const wasm_val_t args[], wasm_val_t results[]
+) {
+  return release_trap(
+    prepared->call(reveal_val_vec(args), reveal_val_vec(results)));
+}
+
+size_t wasm_func_prepared_call_batch(
+  wasm_func_prepared_t* prepared, size_t n,
+  const wasm_val_t args[], wasm_val_t results[], wasm_trap_t* traps[]
+) {
+  return prepared->call_batch(n, reveal_val_vec(args), reveal_val_vec(results),
+    reveal_traps(n, traps));
+}
+
 
 // Global Instances
 
@@ -868,6 +1104,42 @@ void wasm_global_set(wasm_global_t* global, const wasm_val_t* val) {
   global->set(val_.it);
 }
 
+wasm_valkind_t wasm_global_kind(const wasm_global_t* global) {
+  return hide_valkind(global->kind());
+}
+
+int32_t wasm_global_get_i32(const wasm_global_t* global) {
+  return global->get_i32();
+}
+
+int64_t wasm_global_get_i64(const wasm_global_t* global) {
+  return global->get_i64();
+}
+
+float32_t wasm_global_get_f32(const wasm_global_t* global) {
+  return global->get_f32();
+}
+
+float64_t wasm_global_get_f64(const wasm_global_t* global) {
+  return global->get_f64();
+}
+
+void wasm_global_set_i32(wasm_global_t* global, int32_t val) {
+  global->set_i32(val);
+}
+
+void wasm_global_set_i64(wasm_global_t* global, int64_t val) {
+  global->set_i64(val);
+}
+
+void wasm_global_set_f32(wasm_global_t* global, float32_t val) {
+  global->set_f32(val);
+}
+
+void wasm_global_set_f64(wasm_global_t* global, float64_t val) {
+  global->set_f64(val);
+}
+
 
 // Table Instances
 
@@ -903,6 +1175,38 @@ bool wasm_table_grow(
   return table->grow(delta, ref);
 }
 
+bool wasm_table_fill(
+  wasm_table_t* table, wasm_table_size_t index, wasm_table_size_t n,
+  wasm_ref_t* ref
+) {
+  return table->fill(index, n, ref);
+}
+
+bool wasm_table_copy_range(
+  wasm_table_t* table, wasm_table_size_t index,
+  const wasm_table_t* src, wasm_table_size_t src_index, wasm_table_size_t n
+) {
+  return table->copy_range(index, src, src_index, n);
+}
+
+bool wasm_table_get_range(
+  const wasm_table_t* table, wasm_table_size_t index, wasm_table_size_t n,
+  wasm_ref_t* out[]
+) {
+  static_assert(sizeof(wasm_ref_t*) == sizeof(own<Ref>),
+    "C/C++ incompatibility");
+  for (size_t i = 0; i < n; ++i) out[i] = nullptr;
+  return table->get_range(index, n, reinterpret_cast<own<Ref>*>(out));
+}
+
+bool wasm_table_set_range(
+  wasm_table_t* table, wasm_table_size_t index, wasm_table_size_t n,
+  wasm_ref_t* const refs[]
+) {
+  return table->set_range(
+    index, n, reinterpret_cast<const Ref* const*>(refs));
+}
+
 
 // Memory Instances
 
@@ -935,6 +1239,98 @@ bool wasm_memory_grow(wasm_memory_t* memory, wasm_memory_pages_t delta) {
 }
 
 
+// Memory Views
+
+WASM_DEFINE_OWN(memory_view, Memory::View)
+
+static_assert(sizeof(wasm_memory_segment_t) == sizeof(Memory::View::Segment),
+  "C/C++ incompatibility");
+
+extern "C++" inline auto reveal_memory_segments(
+  const wasm_memory_segment_t* segments
+) -> const Memory::View::Segment* {
+  return reinterpret_cast<const Memory::View::Segment*>(segments);
+}
+
+wasm_memory_view_t* wasm_memory_view_new(const wasm_memory_t* memory) {
+  return release_memory_view(memory->view());
+}
+
+const wasm_memory_t* wasm_memory_view_memory(const wasm_memory_view_t* view) {
+  return hide_memory(view->memory());
+}
+
+wasm_byte_t* wasm_memory_view_data(wasm_memory_view_t* view) {
+  return view->data();
+}
+
+size_t wasm_memory_view_data_size(wasm_memory_view_t* view) {
+  return view->data_size();
+}
+
+bool wasm_memory_view_read(
+  wasm_memory_view_t* view, size_t offset, byte_t* dst, size_t size
+) {
+  return view->read(offset, dst, size);
+}
+
+bool wasm_memory_view_write(
+  wasm_memory_view_t* view, size_t offset, const byte_t* src, size_t size
+) {
+  return view->write(offset, src, size);
+}
+
+bool wasm_memory_view_fill(
+  wasm_memory_view_t* view, size_t offset, byte_t value, size_t size
+) {
+  return view->fill(offset, value, size);
+}
+
+bool wasm_memory_view_gather(
+  wasm_memory_view_t* view, const wasm_memory_segment_t segments[], size_t n
+) {
+  return view->gather(reveal_memory_segments(segments), n);
+}
+
+bool wasm_memory_view_scatter(
+  wasm_memory_view_t* view, const wasm_memory_segment_t segments[], size_t n
+) {
+  return view->scatter(reveal_memory_segments(segments), n);
+}
+
+
+// Memory Images
+
+WASM_DEFINE_OWN(memory_image, Memory::Image)
+
+wasm_memory_image_t* wasm_memory_image_new(const wasm_byte_vec_t* data) {
+  return release_memory_image(Memory::Image::make(data->data, data->size));
+}
+
+wasm_memory_image_t* wasm_memory_image_new_from_file(
+  int fd, size_t offset, size_t size
+) {
+  return release_memory_image(Memory::Image::make_from_file(fd, offset, size));
+}
+
+size_t wasm_memory_image_size(const wasm_memory_image_t* image) {
+  return image->size();
+}
+
+wasm_memory_t* wasm_memory_new_with_image(
+  wasm_store_t* store, const wasm_memorytype_t* type,
+  const wasm_memory_image_t* image
+) {
+  return release_memory(Memory::make(store, type, image));
+}
+
+bool wasm_memory_map(
+  wasm_memory_t* memory, size_t offset, const wasm_memory_image_t* image
+) {
+  return memory->map(offset, image);
+}
+
+
 // Externals
 
 WASM_DEFINE_REF(extern, Extern)
@@ -1024,6 +1420,133 @@ void wasm_instance_exports(
   *out = release_extern_vec(instance->exports());
 }
 
+wasm_extern_t* wasm_instance_export_by_index(
+  const wasm_instance_t* instance, size_t index
+) {
+  return release_extern(instance->export_by_index(index));
+}
+
+wasm_extern_t* wasm_instance_export_by_name(
+  const wasm_instance_t* instance, const wasm_name_t* name
+) {
+  auto name_ = borrow_byte_vec(name);
+  return release_extern(instance->export_by_name(name_.it));
+}
+
+
+// Prepared Instantiation
+
+WASM_DEFINE_OWN(instance_prepared, Instance::Prepared)
+
+wasm_instance_prepared_t* wasm_instance_prepare(
+  wasm_store_t* store,
+  const wasm_module_t* module,
+  const wasm_extern_vec_t* imports
+) {
+  auto imports_ = reveal_extern_vec(imports);
+  return release_instance_prepared(Instance::prepare(store, module, *imports_));
+}
+
+wasm_instance_t* wasm_instance_prepared_instantiate(
+  const wasm_instance_prepared_t* prepared, wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto instance = release_instance(prepared->instantiate(&error));
+  if (trap) *trap = hide_trap(error.release());
+  return instance;
+}
+
+
+// Instance Snapshots
+
+WASM_DEFINE_OWN(instance_snapshot, Instance::Snapshot)
+
+wasm_instance_snapshot_t* wasm_instance_snapshot(
+  const wasm_instance_t* instance
+) {
+  return release_instance_snapshot(instance->snapshot());
+}
+
+wasm_instance_t* wasm_instance_snapshot_instantiate(
+  const wasm_instance_snapshot_t* snapshot,
+  wasm_store_t* store,
+  const wasm_extern_vec_t* imports,
+  wasm_trap_t** trap
+) {
+  auto imports_ = reveal_extern_vec(imports);
+  own<Trap> error;
+  auto instance = release_instance(
+    snapshot->instantiate(store, *imports_, &error));
+  if (trap) *trap = hide_trap(error.release());
+  return instance;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Executors
+
+WASM_DEFINE_OWN(executor, Executor)
+
+extern "C++" {
+
+struct wasm_executor_setup_env_t {
+  wasm_executor_setup_callback_t setup;
+  void* env;
+};
+
+auto wasm_executor_setup(void* env, Store* store, const Module* module)
+  -> own<Instance> {
+  auto t = static_cast<wasm_executor_setup_env_t*>(env);
+  return adopt_instance(t->setup(t->env, hide_store(store), hide_module(module)));
+}
+
+struct wasm_executor_env_t {
+  wasm_executor_callback_t callback;
+  void* env;
+};
+
+void wasm_executor_callback(
+  void* env, const vec<Val>& results, const Message* trap
+) {
+  auto t = static_cast<wasm_executor_env_t*>(env);
+  t->callback(t->env, hide_val_vec(results),
+    trap ? hide_byte_vec(*trap) : nullptr);
+  delete t;
+}
+
+}  // extern "C++"
+
+wasm_executor_t* wasm_executor_new(
+  wasm_engine_t* engine, const wasm_shared_module_t* shared, size_t threads,
+  wasm_executor_setup_callback_t setup, void* env
+) {
+  // Setup callbacks only run while the executor is being made.
+  wasm_executor_setup_env_t env2 = {setup, env};
+  return release_executor(Executor::make(engine, shared, threads,
+    setup ? wasm_executor_setup : nullptr, &env2));
+}
+
+size_t wasm_executor_threads(const wasm_executor_t* executor) {
+  return executor->threads();
+}
+
+void wasm_executor_submit(
+  wasm_executor_t* executor, size_t export_index, const wasm_val_vec_t* args,
+  wasm_executor_callback_t callback, void* env
+) {
+  // Arguments are borrowed. References cannot cross to a worker's store, so
+  // they are passed on as null, and the worker rejects the call as mistyped.
+  auto args2 = vec<Val>::make_uninitialized(args->size);
+  for (size_t i = 0; i < args->size; ++i) {
+    if (!is_ref(reveal_valkind(args->data[i].kind))) {
+      args2[i] = adopt_val(args->data[i]);
+    }
+  }
+  auto env2 = new wasm_executor_env_t{callback, env};
+  executor->submit(
+    export_index, std::move(args2), wasm_executor_callback, env2);
+}
+
 
 wasm_instance_t* wasm_frame_instance(const wasm_frame_t* frame) {
   return hide_instance(reveal_frame(frame)->instance());
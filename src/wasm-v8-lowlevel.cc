@@ -13,10 +13,22 @@
 #include "objects/js-collection.h"
 
 #include "api/api.h"
+#include "execution/execution.h"
+#include "execution/frames-inl.h"
+#include "objects/frame-array-inl.h"
 #include "api/api-inl.h"
 #include "wasm/wasm-objects.h"
+#include "wasm/wasm-engine.h"
+#include "wasm/wasm-module.h"
 #include "wasm/wasm-objects-inl.h"
 #include "wasm/wasm-serialization.h"
+#include "compiler/wasm-compiler.h"
+#include "wasm/wasm-features.h"
+#include "wasm/streaming-decoder.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
 
 
 namespace v8 {
@@ -36,6 +48,21 @@ auto object_isolate(const v8::Persistent<v8::Object>& obj) -> v8::Isolate* {
   return v8_obj->GetIsolate();
 }
 
+// Plain read of the counter; only valid on the isolate's thread.
+auto isolate_external_memory(v8::Isolate* isolate) -> int64_t {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  return v8_isolate->heap()->external_memory();
+}
+
+// Reads the object straight out of the persistent's slot. Only valid as
+// long as nothing can trigger a GC.
+template<class T>
+auto object_raw(const v8::Persistent<v8::Object>& obj) -> T {
+  struct FakePersistent { v8::internal::Address* location; };
+  auto location = reinterpret_cast<const FakePersistent*>(&obj)->location;
+  return T::cast(v8::internal::Object(*location));
+}
+
 template<class T>
 auto object_handle(T v8_obj) -> v8::internal::Handle<T> {
   return handle(v8_obj, v8_obj.GetIsolate());
@@ -180,6 +207,11 @@ auto global_type_content(v8::Local<v8::Object> global) -> val_kind_t {
   return v8_valtype_to_wasm(v8_global->type());
 }
 
+auto global_type_content(const v8::Persistent<v8::Object>& global) -> val_kind_t {
+  return v8_valtype_to_wasm(
+    object_raw<v8::internal::WasmGlobalObject>(global).type());
+}
+
 auto global_type_mutable(v8::Local<v8::Object> global) -> bool {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(global);
   auto v8_global = v8::internal::Handle<v8::internal::WasmGlobalObject>::cast(v8_object);
@@ -254,6 +286,109 @@ auto module_deserialize(
   return v8::MaybeLocal<v8::Object>(v8::Utils::ToLocal(v8_module));
 }
 
+// The native module holds the wire bytes and the compiled code and can be
+// shared by module objects in all isolates of the process.
+auto module_native(v8::Local<v8::Object> module) -> std::shared_ptr<void> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(module);
+  auto v8_module = v8::internal::Handle<v8::internal::WasmModuleObject>::cast(v8_object);
+  return v8_module->shared_native_module();
+}
+
+auto module_import(
+  v8::Isolate* isolate, const std::shared_ptr<void>& native
+) -> v8::MaybeLocal<v8::Object> {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto native_module =
+    std::static_pointer_cast<v8::internal::wasm::NativeModule>(native);
+  auto v8_module = v8_isolate->wasm_engine()->ImportNativeModule(
+    v8_isolate, std::move(native_module));
+  if (v8_module.is_null()) return v8::MaybeLocal<v8::Object>();
+  return v8::MaybeLocal<v8::Object>(v8::Utils::ToLocal(
+    v8::internal::Handle<v8::internal::JSObject>::cast(v8_module)));
+}
+
+auto module_native_size(const std::shared_ptr<void>& native) -> size_t {
+  auto native_module =
+    static_cast<v8::internal::wasm::NativeModule*>(native.get());
+  return native_module->committed_code_space() +
+    native_module->wire_bytes().size();
+}
+
+
+// Streaming compilation straight on the Wasm engine, as v8::WasmStreaming
+// does it, but without a JS Response and promise in between. The result is
+// delivered through a foreground task, so the caller has to pump the
+// isolate's message loop until the compilation is no longer pending.
+
+namespace {
+
+class CompileResolver : public v8::internal::wasm::CompilationResultResolver {
+ public:
+  explicit CompileResolver(v8::Isolate* isolate) : isolate_(isolate) {}
+
+  void OnCompilationSucceeded(
+    v8::internal::Handle<v8::internal::WasmModuleObject> result
+  ) override {
+    auto v8_module = v8::internal::Handle<v8::internal::JSObject>::cast(result);
+    result_.Reset(isolate_, v8::Utils::ToLocal(v8_module));
+    state_ = COMPILE_SUCCEEDED;
+  }
+
+  void OnCompilationFailed(v8::internal::Handle<v8::internal::Object>) override {
+    state_ = COMPILE_FAILED;
+  }
+
+  v8::Isolate* isolate_;
+  v8::Global<v8::Object> result_;
+  compile_state_t state_ = COMPILE_PENDING;
+};
+
+struct Compilation {
+  std::shared_ptr<CompileResolver> resolver;
+  std::shared_ptr<v8::internal::wasm::StreamingDecoder> decoder;
+};
+
+auto compilation(const std::shared_ptr<void>& job) -> Compilation* {
+  return static_cast<Compilation*>(job.get());
+}
+
+}  // namespace
+
+auto compile_start(v8::Local<v8::Context> context) -> std::shared_ptr<void> {
+  auto isolate = context->GetIsolate();
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto job = std::make_shared<Compilation>();
+  job->resolver = std::make_shared<CompileResolver>(isolate);
+  job->decoder = v8_isolate->wasm_engine()->StartStreamingCompilation(
+    v8_isolate, v8::internal::wasm::WasmFeaturesFromIsolate(v8_isolate),
+    v8::Utils::OpenHandle(*context), job->resolver);
+  return job;
+}
+
+void compile_feed(const std::shared_ptr<void>& job, const uint8_t* data, size_t size) {
+  compilation(job)->decoder->OnBytesReceived(
+    v8::internal::Vector<const uint8_t>(data, size));
+}
+
+void compile_finish(const std::shared_ptr<void>& job) {
+  compilation(job)->decoder->Finish();
+}
+
+// An aborted compilation never settles.
+void compile_abort(const std::shared_ptr<void>& job) {
+  compilation(job)->decoder->Abort();
+}
+
+auto compile_state(const std::shared_ptr<void>& job) -> compile_state_t {
+  return compilation(job)->resolver->state_;
+}
+
+auto compile_result(const std::shared_ptr<void>& job) -> v8::MaybeLocal<v8::Object> {
+  auto resolver = compilation(job)->resolver.get();
+  if (resolver->state_ != COMPILE_SUCCEEDED) return v8::MaybeLocal<v8::Object>();
+  return resolver->result_.Get(resolver->isolate_);
+}
+
 
 // Instances
 
@@ -271,6 +406,94 @@ auto instance_exports(v8::Local<v8::Object> instance) -> v8::Local<v8::Object> {
   return v8::Utils::ToLocal(v8_exports);
 }
 
+// Only the instance's own memory, tables, and globals, not imported ones.
+auto instance_memory(v8::Local<v8::Object> instance) -> v8::MaybeLocal<v8::Object> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  if (!v8_instance->has_memory_object()) return v8::MaybeLocal<v8::Object>();
+  for (auto& import: v8_instance->module()->import_table) {
+    if (import.kind == v8::internal::wasm::kExternalMemory) {
+      return v8::MaybeLocal<v8::Object>();
+    }
+  }
+  auto v8_memory = object_handle(v8::internal::JSObject::cast(v8_instance->memory_object()));
+  return v8::MaybeLocal<v8::Object>(v8::Utils::ToLocal(v8_memory));
+}
+
+auto instance_tables(
+  v8::Local<v8::Object> instance, v8::Local<v8::Object> tables[], size_t max
+) -> size_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto& module_tables = v8_instance->module()->tables;
+  auto v8_tables = v8_instance->tables();
+  size_t n = 0;
+  for (size_t i = 0; i < module_tables.size(); ++i) {
+    if (module_tables[i].imported) continue;
+    auto v8_table = v8_tables.get(static_cast<int>(i));
+    if (!v8_table.IsWasmTableObject()) continue;
+    if (n < max) {
+      tables[n] = v8::Utils::ToLocal(
+        object_handle(v8::internal::JSObject::cast(v8_table)));
+    }
+    ++n;
+  }
+  return n;
+}
+
+auto instance_func(
+  v8::Local<v8::Object> instance, uint32_t index
+) -> v8::Local<v8::Function> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  auto v8_func =
+    v8::internal::WasmInstanceObject::GetOrCreateWasmExportedFunction(
+      v8_instance->GetIsolate(), v8_instance, static_cast<int>(index));
+  return v8::Utils::ToLocal(
+    v8::internal::Handle<v8::internal::JSFunction>::cast(v8_func));
+}
+
+namespace {
+
+template<class F>
+auto instance_globals(v8::Local<v8::Object> instance, F f) -> size_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
+  auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
+  size_t offset = 0;
+  for (auto& global: v8_instance->module()->globals) {
+    if (global.imported || !global.mutability) continue;
+    size_t size;
+    switch (global.type) {
+      case v8::internal::wasm::kWasmI32:
+      case v8::internal::wasm::kWasmF32: size = 4; break;
+      case v8::internal::wasm::kWasmI64:
+      case v8::internal::wasm::kWasmF64: size = 8; break;
+      default: continue;
+    }
+    f(v8_instance->globals_start() + global.offset, offset, size);
+    offset += size;
+  }
+  return offset;
+}
+
+}  // namespace
+
+auto instance_globals_size(v8::Local<v8::Object> instance) -> size_t {
+  return instance_globals(instance, [](uint8_t*, size_t, size_t) {});
+}
+
+void instance_globals_save(v8::Local<v8::Object> instance, char* buffer) {
+  instance_globals(instance, [=](uint8_t* global, size_t offset, size_t size) {
+    std::memcpy(buffer + offset, global, size);
+  });
+}
+
+void instance_globals_restore(v8::Local<v8::Object> instance, const char* buffer) {
+  instance_globals(instance, [=](uint8_t* global, size_t offset, size_t size) {
+    std::memcpy(global, buffer + offset, size);
+  });
+}
+
 
 // Externals
 
@@ -294,6 +517,176 @@ auto func_instance(v8::Local<v8::Function> function) -> v8::Local<v8::Object> {
   return v8::Utils::ToLocal(v8_instance);
 }
 
+auto func_index(v8::Local<v8::Function> function) -> uint32_t {
+  auto v8_function = v8::Utils::OpenHandle(*function);
+  auto v8_func = v8::internal::Handle<v8::internal::WasmExportedFunction>::cast(v8_function);
+  return static_cast<uint32_t>(v8_func->function_index());
+}
+
+// C-to-Wasm entry stubs only depend on the signature, but V8 compiles
+// them per instance, into the instance's debug info. Entries are instead
+// kept per isolate, since code cannot be shared across isolates.
+
+namespace {
+
+struct EntryCache {
+  std::unordered_map<std::string, v8::Global<v8::Value>> entries;
+};
+
+auto entry_key(v8::internal::wasm::FunctionSig* sig) -> std::string {
+  std::string key;
+  for (size_t i = 0; i < sig->return_count(); ++i) {
+    key.push_back(static_cast<char>(sig->GetReturn(i)));
+  }
+  key.push_back(static_cast<char>(v8::internal::wasm::kWasmStmt));
+  for (size_t i = 0; i < sig->parameter_count(); ++i) {
+    key.push_back(static_cast<char>(sig->GetParam(i)));
+  }
+  return key;
+}
+
+}  // namespace
+
+// Must be destroyed before its isolate.
+auto entry_cache_new() -> std::shared_ptr<void> {
+  return std::make_shared<EntryCache>();
+}
+
+// Calls the function through the C-to-Wasm entry stub for its signature,
+// taken from the cache. Arguments are read from the packed buffer back to
+// back at their natural sizes, and the result, if any, is written to its
+// start. The signature must have numeric types and at most one result.
+// An exception is left in *exception instead of being rethrown.
+auto func_call_entry(
+  v8::Local<v8::Function> function, char* packed,
+  v8::Local<v8::Value>* exception, const std::shared_ptr<void>& entry_cache
+) -> call_result_t {
+  auto v8_object = v8::Utils::OpenHandle(*function);
+  auto v8_function = v8::internal::Handle<v8::internal::WasmExportedFunction>::cast(v8_object);
+  auto v8_isolate = v8_function->GetIsolate();
+  v8::internal::Handle<v8::internal::WasmInstanceObject> v8_instance(
+    v8_function->instance(), v8_isolate);
+  auto func_index = v8_function->function_index();
+  auto sig = v8_instance->module()->functions[func_index].sig;
+
+  auto isolate = reinterpret_cast<v8::Isolate*>(v8_isolate);
+  auto& entries = static_cast<EntryCache*>(entry_cache.get())->entries;
+  auto key = entry_key(sig);
+  auto it = entries.find(key);
+  if (it == entries.end()) {
+    auto code = v8::internal::compiler::CompileCWasmEntry(v8_isolate, sig)
+      .ToHandleChecked();
+    auto v8_code = v8::Utils::ToLocal(
+      v8::internal::Handle<v8::internal::Object>::cast(code));
+    it = entries.emplace(key, v8::Global<v8::Value>(isolate, v8_code)).first;
+  }
+  auto entry = v8::internal::Handle<v8::internal::Code>::cast(
+    v8::Utils::OpenHandle(*it->second.Get(isolate)));
+
+  v8::internal::Address target;
+  v8::internal::Handle<v8::internal::Object> object_ref;
+  if (func_index < static_cast<int>(v8_instance->module()->num_imported_functions)) {
+    v8::internal::ImportedFunctionEntry imported(v8_instance, func_index);
+    target = imported.target();
+    object_ref = v8::internal::handle(imported.object_ref(), v8_isolate);
+  } else {
+    target = v8_instance->module_object().native_module()
+      ->GetCallTargetForFunction(func_index);
+    object_ref = v8_instance;
+  }
+
+  v8::internal::Execution::CallWasm(v8_isolate, entry, target, object_ref,
+    reinterpret_cast<v8::internal::Address>(packed));
+  if (!v8_isolate->has_pending_exception()) return CALL_OK;
+
+  auto pending = v8::internal::handle(v8_isolate->pending_exception(), v8_isolate);
+  v8_isolate->clear_pending_exception();
+  v8_isolate->clear_pending_message();
+  if (!v8_isolate->is_catchable_by_javascript(*pending)) return CALL_TERMINATED;
+  *exception = v8::Utils::ToLocal(pending);
+  return CALL_EXCEPTION;
+}
+
+// Collects the Wasm frames of the current stack, innermost first.
+auto stack_frames(
+  v8::Isolate* isolate, stack_frame_t frames[], size_t max
+) -> size_t {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  size_t n = 0;
+  for (v8::internal::StackTraceFrameIterator it(v8_isolate);
+       !it.done() && n < max; it.Advance()) {
+    if (!it.is_wasm()) continue;
+    auto summary = v8::internal::FrameSummary::GetTop(it.frame()).AsWasm();
+    auto v8_instance = summary.wasm_instance();
+    frames[n].instance = v8::Utils::ToLocal(
+      v8::internal::Handle<v8::internal::JSObject>::cast(v8_instance));
+    frames[n].func_index = summary.function_index();
+    frames[n].func_offset = summary.byte_offset();
+    frames[n].module_offset = summary.SourcePosition();
+    ++n;
+  }
+  return n;
+}
+
+// Reads the Wasm frames of the stack trace that V8 captured in raw form when
+// the error was created, innermost first. Returns the number of Wasm frames,
+// of which at most max are stored.
+auto error_frames(
+  v8::Local<v8::Object> error, stack_frame_t frames[], size_t max
+) -> size_t {
+  auto v8_error = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(error);
+  auto v8_isolate = v8_error->GetIsolate();
+  auto v8_trace = v8::internal::JSReceiver::GetDataProperty(
+    v8_error, v8_isolate->factory()->stack_trace_symbol());
+  if (!v8_trace->IsFrameArray()) return 0;
+  auto v8_frames = v8::internal::Handle<v8::internal::FrameArray>::cast(v8_trace);
+
+  size_t n = 0;
+  for (int i = 0; i < v8_frames->FrameCount(); ++i) {
+    if (!v8_frames->IsWasmFrame(i)) continue;
+    if (n < max) {
+      auto v8_instance = v8::internal::handle(
+        v8_frames->WasmInstance(i), v8_isolate);
+      auto func_index = v8_frames->WasmFunctionIndex(i).value();
+      auto offset = v8_frames->Offset(i).value();
+      if (!v8_frames->IsWasmInterpretedFrame(i)) {
+        auto code = reinterpret_cast<const v8::internal::wasm::WasmCode*>(
+          v8::internal::Foreign::cast(v8_frames->WasmCodeObject(i))
+            .foreign_address());
+        offset = v8::internal::FrameSummary::WasmCompiledFrameSummary::
+          GetWasmSourcePosition(code, offset);
+      }
+      frames[n].instance = v8::Utils::ToLocal(
+        v8::internal::Handle<v8::internal::JSObject>::cast(v8_instance));
+      frames[n].func_index = static_cast<uint32_t>(func_index);
+      frames[n].func_offset = static_cast<uint32_t>(offset);
+      frames[n].module_offset = static_cast<uint32_t>(offset +
+        v8::internal::wasm::GetWasmFunctionOffset(
+          v8_instance->module(), static_cast<uint32_t>(func_index)));
+    }
+    ++n;
+  }
+  return n;
+}
+
+// Reads a multi-value result array straight from its backing store.
+// Returns false if the array does not have packed object elements.
+auto func_results(
+  v8::Local<v8::Array> array, v8::Local<v8::Value> results[], size_t size
+) -> bool {
+  auto v8_array = v8::Utils::OpenHandle(*array);
+  auto isolate = v8_array->GetIsolate();
+  if (!v8_array->HasObjectElements()) return false;
+  auto elements = v8::internal::FixedArray::cast(v8_array->elements());
+  if (static_cast<size_t>(elements.length()) < size) return false;
+  for (size_t i = 0; i < size; ++i) {
+    auto element = elements.get(static_cast<int>(i));
+    if (element.IsTheHole(isolate)) return false;
+    results[i] = v8::Utils::ToLocal(v8::internal::handle(element, isolate));
+  }
+  return true;
+}
+
 
 // Globals
 
@@ -349,6 +742,32 @@ void global_set_ref(v8::Local<v8::Object> global, v8::Local<v8::Value> val) {
   v8_global->SetAnyRef(v8::Utils::OpenHandle<v8::Value, v8::internal::Object>(val));
 }
 
+auto global_get_i32(const v8::Persistent<v8::Object>& global) -> int32_t {
+  return object_raw<v8::internal::WasmGlobalObject>(global).GetI32();
+}
+auto global_get_i64(const v8::Persistent<v8::Object>& global) -> int64_t {
+  return object_raw<v8::internal::WasmGlobalObject>(global).GetI64();
+}
+auto global_get_f32(const v8::Persistent<v8::Object>& global) -> float {
+  return object_raw<v8::internal::WasmGlobalObject>(global).GetF32();
+}
+auto global_get_f64(const v8::Persistent<v8::Object>& global) -> double {
+  return object_raw<v8::internal::WasmGlobalObject>(global).GetF64();
+}
+
+void global_set_i32(const v8::Persistent<v8::Object>& global, int32_t val) {
+  object_raw<v8::internal::WasmGlobalObject>(global).SetI32(val);
+}
+void global_set_i64(const v8::Persistent<v8::Object>& global, int64_t val) {
+  object_raw<v8::internal::WasmGlobalObject>(global).SetI64(val);
+}
+void global_set_f32(const v8::Persistent<v8::Object>& global, float val) {
+  object_raw<v8::internal::WasmGlobalObject>(global).SetF32(val);
+}
+void global_set_f64(const v8::Persistent<v8::Object>& global, double val) {
+  object_raw<v8::internal::WasmGlobalObject>(global).SetF64(val);
+}
+
 
 // Tables
 
@@ -409,6 +828,127 @@ auto table_grow(
   return true;
 }
 
+// Range operations check bounds and element values up front, so that they
+// either complete or leave the table untouched.
+
+auto table_range_ok(
+  v8::internal::Handle<v8::internal::WasmTableObject> table,
+  size_t index, size_t n
+) -> bool {
+  size_t size = table->current_length();
+  return index <= size && n <= size - index;
+}
+
+// Anyref tables hold any value, funcref tables null or Wasm functions.
+auto table_element_ok(
+  v8::internal::Isolate* isolate,
+  v8::internal::Handle<v8::internal::WasmTableObject> table,
+  v8::internal::Handle<v8::internal::Object> value
+) -> bool {
+  return table->type() == v8::internal::wasm::kWasmAnyRef ||
+    value->IsNull(isolate) ||
+    v8::internal::WasmExportedFunction::IsWasmExportedFunction(*value);
+}
+
+auto table_fill(
+  v8::Local<v8::Object> table, size_t index, size_t n, v8::Local<v8::Value> value
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
+  auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
+  auto v8_value = v8::Utils::OpenHandle<v8::Value, v8::internal::Object>(value);
+  auto isolate = v8_table->GetIsolate();
+  if (!table_range_ok(v8_table, index, n) ||
+      !table_element_ok(isolate, v8_table, v8_value)) {
+    return false;
+  }
+
+  v8::TryCatch handler(table->GetIsolate());
+  for (size_t i = 0; i < n; ++i) {
+    v8::internal::HandleScope scope(isolate);
+    v8::internal::WasmTableObject::Set(isolate, v8_table,
+      static_cast<uint32_t>(index + i), v8_value);
+    if (handler.HasCaught()) return false;
+  }
+  return true;
+}
+
+auto table_copy(
+  v8::Local<v8::Object> dst, size_t dst_index,
+  v8::Local<v8::Object> src, size_t src_index, size_t n
+) -> bool {
+  auto v8_dst_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(dst);
+  auto v8_dst = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_dst_object);
+  auto v8_src_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(src);
+  auto v8_src = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_src_object);
+  if (!table_range_ok(v8_dst, dst_index, n) ||
+      !table_range_ok(v8_src, src_index, n)) {
+    return false;
+  }
+
+  auto isolate = v8_dst->GetIsolate();
+  if (v8_dst->type() != v8_src->type()) {
+    for (size_t i = 0; i < n; ++i) {
+      v8::internal::HandleScope scope(isolate);
+      auto v8_value = v8::internal::WasmTableObject::Get(
+        isolate, v8_src, static_cast<uint32_t>(src_index + i));
+      if (!table_element_ok(isolate, v8_dst, v8_value)) return false;
+    }
+  }
+
+  // Copy backwards when ranges in the same table overlap downwards.
+  bool backwards = v8_dst.is_identical_to(v8_src) && dst_index > src_index;
+  v8::TryCatch handler(dst->GetIsolate());
+  for (size_t k = 0; k < n; ++k) {
+    auto i = backwards ? n - 1 - k : k;
+    v8::internal::HandleScope scope(isolate);
+    auto v8_value = v8::internal::WasmTableObject::Get(
+      isolate, v8_src, static_cast<uint32_t>(src_index + i));
+    v8::internal::WasmTableObject::Set(isolate, v8_dst,
+      static_cast<uint32_t>(dst_index + i), v8_value);
+    if (handler.HasCaught()) return false;
+  }
+  return true;
+}
+
+auto table_get_range(
+  v8::Local<v8::Object> table, size_t index, size_t n,
+  v8::Local<v8::Value> values[]
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
+  auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
+  if (!table_range_ok(v8_table, index, n)) return false;
+
+  auto isolate = v8_table->GetIsolate();
+  for (size_t i = 0; i < n; ++i) {
+    values[i] = v8::Utils::ToLocal(v8::internal::WasmTableObject::Get(
+      isolate, v8_table, static_cast<uint32_t>(index + i)));
+  }
+  return true;
+}
+
+auto table_set_range(
+  v8::Local<v8::Object> table, size_t index, size_t n,
+  const v8::Local<v8::Value> values[]
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(table);
+  auto v8_table = v8::internal::Handle<v8::internal::WasmTableObject>::cast(v8_object);
+  auto isolate = v8_table->GetIsolate();
+  if (!table_range_ok(v8_table, index, n)) return false;
+  for (size_t i = 0; i < n; ++i) {
+    if (!table_element_ok(isolate, v8_table, v8::Utils::OpenHandle(*values[i]))) {
+      return false;
+    }
+  }
+
+  v8::TryCatch handler(table->GetIsolate());
+  for (size_t i = 0; i < n; ++i) {
+    v8::internal::WasmTableObject::Set(isolate, v8_table,
+      static_cast<uint32_t>(index + i), v8::Utils::OpenHandle(*values[i]));
+    if (handler.HasCaught()) return false;
+  }
+  return true;
+}
+
 
 // Memory
 
@@ -3,12 +3,16 @@
 
 #include "v8.h"
 
+#include <memory>
+
 namespace v8 {
 namespace wasm {
 
 auto object_isolate(v8::Local<v8::Object>) -> v8::Isolate*;
 auto object_isolate(const v8::Persistent<v8::Object>&) -> v8::Isolate*;
 
+auto isolate_external_memory(v8::Isolate*) -> int64_t;
+
 auto object_is_module(v8::Local<v8::Object>) -> bool;
 auto object_is_instance(v8::Local<v8::Object>) -> bool;
 auto object_is_func(v8::Local<v8::Object>) -> bool;
@@ -30,6 +34,7 @@ auto func_type_param(v8::Local<v8::Object> global, size_t) -> val_kind_t;
 auto func_type_result(v8::Local<v8::Object> global, size_t) -> val_kind_t;
 
 auto global_type_content(v8::Local<v8::Object> global) -> val_kind_t;
+auto global_type_content(const v8::Persistent<v8::Object>& global) -> val_kind_t;
 auto global_type_mutable(v8::Local<v8::Object> global) -> bool;
 
 auto table_type_min(v8::Local<v8::Object> table) -> uint32_t;
@@ -43,14 +48,47 @@ auto module_binary(v8::Local<v8::Object> module) -> const char*;
 auto module_serialize_size(v8::Local<v8::Object> module) -> size_t;
 auto module_serialize(v8::Local<v8::Object> module, char*, size_t) -> bool;
 auto module_deserialize(v8::Isolate*, const char*, size_t, const char*, size_t) -> v8::MaybeLocal<v8::Object>;
+auto module_native(v8::Local<v8::Object> module) -> std::shared_ptr<void>;
+auto module_import(v8::Isolate*, const std::shared_ptr<void>&) -> v8::MaybeLocal<v8::Object>;
+auto module_native_size(const std::shared_ptr<void>&) -> size_t;
+
+enum compile_state_t { COMPILE_PENDING, COMPILE_SUCCEEDED, COMPILE_FAILED };
+auto compile_start(v8::Local<v8::Context>) -> std::shared_ptr<void>;
+void compile_feed(const std::shared_ptr<void>&, const uint8_t*, size_t);
+void compile_finish(const std::shared_ptr<void>&);
+void compile_abort(const std::shared_ptr<void>&);
+auto compile_state(const std::shared_ptr<void>&) -> compile_state_t;
+auto compile_result(const std::shared_ptr<void>&) -> v8::MaybeLocal<v8::Object>;
 
 auto instance_module(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
 auto instance_exports(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
+auto instance_memory(v8::Local<v8::Object> instance) -> v8::MaybeLocal<v8::Object>;
+auto instance_tables(v8::Local<v8::Object> instance, v8::Local<v8::Object>[], size_t max) -> size_t;
+auto instance_func(v8::Local<v8::Object> instance, uint32_t index) -> v8::Local<v8::Function>;
+auto instance_globals_size(v8::Local<v8::Object> instance) -> size_t;
+void instance_globals_save(v8::Local<v8::Object> instance, char*);
+void instance_globals_restore(v8::Local<v8::Object> instance, const char*);
 
 enum extern_kind_t { EXTERN_FUNC, EXTERN_GLOBAL, EXTERN_TABLE, EXTERN_MEMORY };
 auto extern_kind(v8::Local<v8::Object> external) -> extern_kind_t;
 
 auto func_instance(v8::Local<v8::Function>) -> v8::Local<v8::Object>;
+auto func_index(v8::Local<v8::Function>) -> uint32_t;
+
+struct stack_frame_t {
+  v8::Local<v8::Object> instance;
+  uint32_t func_index;
+  uint32_t func_offset;
+  uint32_t module_offset;
+};
+
+auto stack_frames(v8::Isolate*, stack_frame_t[], size_t max) -> size_t;
+auto error_frames(v8::Local<v8::Object> error, stack_frame_t[], size_t max) -> size_t;
+auto func_results(v8::Local<v8::Array>, v8::Local<v8::Value>[], size_t) -> bool;
+
+enum call_result_t { CALL_OK, CALL_EXCEPTION, CALL_TERMINATED };
+auto entry_cache_new() -> std::shared_ptr<void>;
+auto func_call_entry(v8::Local<v8::Function>, char* packed, v8::Local<v8::Value>* exception, const std::shared_ptr<void>& entry_cache) -> call_result_t;
 
 auto global_get_i32(v8::Local<v8::Object> global) -> int32_t;
 auto global_get_i64(v8::Local<v8::Object> global) -> int64_t;
@@ -63,10 +101,24 @@ void global_set_f32(v8::Local<v8::Object> global, float);
 void global_set_f64(v8::Local<v8::Object> global, double);
 void global_set_ref(v8::Local<v8::Object> global, v8::Local<v8::Value>);
 
+// These access numeric globals without creating any handles.
+auto global_get_i32(const v8::Persistent<v8::Object>& global) -> int32_t;
+auto global_get_i64(const v8::Persistent<v8::Object>& global) -> int64_t;
+auto global_get_f32(const v8::Persistent<v8::Object>& global) -> float;
+auto global_get_f64(const v8::Persistent<v8::Object>& global) -> double;
+void global_set_i32(const v8::Persistent<v8::Object>& global, int32_t);
+void global_set_i64(const v8::Persistent<v8::Object>& global, int64_t);
+void global_set_f32(const v8::Persistent<v8::Object>& global, float);
+void global_set_f64(const v8::Persistent<v8::Object>& global, double);
+
 auto table_get(v8::Local<v8::Object> table, size_t index) -> v8::MaybeLocal<v8::Value>;
 auto table_set(v8::Local<v8::Object> table, size_t index, v8::Local<v8::Value>) -> bool;
 auto table_size(v8::Local<v8::Object> table) -> size_t;
 auto table_grow(v8::Local<v8::Object> table, size_t delta, v8::Local<v8::Value>) -> bool;
+auto table_fill(v8::Local<v8::Object> table, size_t index, size_t n, v8::Local<v8::Value>) -> bool;
+auto table_copy(v8::Local<v8::Object> dst, size_t dst_index, v8::Local<v8::Object> src, size_t src_index, size_t n) -> bool;
+auto table_get_range(v8::Local<v8::Object> table, size_t index, size_t n, v8::Local<v8::Value>[]) -> bool;
+auto table_set_range(v8::Local<v8::Object> table, size_t index, size_t n, const v8::Local<v8::Value>[]) -> bool;
 
 auto memory_data(v8::Local<v8::Object> memory) -> char*;
 auto memory_data_size(v8::Local<v8::Object> memory)-> size_t;
@@ -5,8 +5,27 @@
 #include "v8.h"
 #include "libplatform/libplatform.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef WASM_API_DEBUG
 #include <atomic>
@@ -25,6 +44,13 @@ namespace v8 {
     extern bool FLAG_experimental_wasm_anyref;
     extern bool FLAG_experimental_wasm_bulk_memory;
     extern bool FLAG_experimental_wasm_return_call;
+    extern bool FLAG_liftoff;
+    extern bool FLAG_wasm_tier_up;
+    extern bool FLAG_wasm_lazy_compilation;
+    extern int FLAG_wasm_num_compilation_tasks;
+    extern unsigned int FLAG_wasm_max_code_space;
+    extern bool FLAG_perf_basic_prof;
+    extern bool FLAG_perf_prof;
   }
 }
 
@@ -38,10 +64,47 @@ namespace wasm {
   exit(1);
 }
 
+[[noreturn]] void OUT_OF_MEMORY(const char* s) {
+  std::cerr << "Wasm API: out of memory for " << s << "!\n";
+  exit(1);
+}
+
 template<class T>
 void ignore(T) {}
 
 
+// FNV-1a
+
+auto hash_bytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325)
+  -> uint64_t {
+  auto bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3;
+  }
+  return hash;
+}
+
+
+// Scratch array that lives on the stack unless it is larger than N.
+// Failing to allocate one is fatal: it is needed halfway through calls
+// and callbacks, where there is no way to report the failure.
+
+template<class T, size_t N = 16>
+class small_array {
+  T inline_[N];
+  std::unique_ptr<T[]> heap_;
+
+public:
+  explicit small_array(size_t size) :
+    heap_(size > N ? new(std::nothrow) T[size] : nullptr) {
+    if (size > N && !heap_) OUT_OF_MEMORY("scratch array");
+  }
+
+  auto get() -> T* { return heap_ ? heap_.get() : inline_; }
+  auto operator[](size_t i) -> T& { return get()[i]; }
+};
+
+
 template<class C> struct implement;
 
 template<class C>
@@ -65,6 +128,8 @@ struct Stats {
     EXTERNTYPE, IMPORTTYPE, EXPORTTYPE,
     VAL, REF, TRAP,
     MODULE, INSTANCE, FUNC, GLOBAL, TABLE, MEMORY, EXTERN,
+    PREPARED_FUNC, PREPARED_INSTANCE, STREAMING_MODULE, MEMORY_VIEW,
+    MEMORY_IMAGE, EXECUTOR, STORE_PROFILE, INSTANCE_SNAPSHOT,
     STRONG_COUNT,
     FUNCDATA_FUNCTYPE, FUNCDATA_VALTYPE,
     CATEGORY_COUNT
@@ -97,8 +162,6 @@ struct Stats {
       made[FUNCDATA_VALTYPE][OWN] - freed[FUNCDATA_VALTYPE][OWN];
     freed[VALTYPE][VEC] +=
       made[FUNCDATA_VALTYPE][VEC] - freed[FUNCDATA_VALTYPE][VEC];
-    // Hack for shared modules.
-    freed[BYTE][VEC] += made[MODULE][SHARED] - freed[MODULE][SHARED];
 
     bool leak = false;
     for (int i = 0; i < STRONG_COUNT; ++i) {
@@ -181,7 +244,9 @@ const char* Stats::name[STRONG_COUNT] = {
   "ValType", "FuncType", "GlobalType", "TableType", "MemoryType",
   "ExternType", "ImportType", "ExportType",
   "Val", "Ref", "Trap",
-  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern"
+  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern",
+  "Func::Prepared", "Instance::Prepared", "Module::Streaming", "Memory::View",
+  "Memory::Image", "Executor", "Store::Profile", "Instance::Snapshot"
 };
 
 const char* Stats::left[CARDINALITY_COUNT] = {
@@ -241,6 +306,19 @@ DEFINE_VEC(Val, vec, VAL)
 // Configuration
 
 struct ConfigImpl : Config {
+  std::string code_cache_dir;
+  size_t code_cache_max_size = 0;
+  size_t module_cache_max_size = 0;
+  Tiering tiering = Tiering::TIERED;
+  bool lazy_compilation = false;
+  size_t compilation_threads = 0;
+  size_t max_code_space = 0;
+  size_t memory_pool_size = 0;
+  size_t store_pool_size = 0;
+  size_t heap_max_old_size = 0;
+  size_t heap_max_young_size = 0;
+  PerfProfiling perf_profiling = PerfProfiling::NONE;
+
   ConfigImpl() { stats.make(Stats::CONFIG, this); }
   ~ConfigImpl() { stats.free(Stats::CONFIG, this); }
 };
@@ -256,13 +334,488 @@ auto Config::make() -> own<Config> {
   return own<Config>(new(std::nothrow) ConfigImpl());
 }
 
+void Config::set_code_cache(const char* dir, size_t max_size) {
+  impl(this)->code_cache_dir = dir ? dir : "";
+  impl(this)->code_cache_max_size = max_size;
+}
+
+void Config::set_module_cache(size_t max_size) {
+  impl(this)->module_cache_max_size = max_size;
+}
+
+void Config::set_tiering(Tiering tiering) {
+  impl(this)->tiering = tiering;
+}
+
+void Config::set_lazy_compilation(bool lazy) {
+  impl(this)->lazy_compilation = lazy;
+}
+
+void Config::set_compilation_threads(size_t n) {
+  impl(this)->compilation_threads = n;
+}
+
+void Config::set_max_code_space(size_t size) {
+  impl(this)->max_code_space = size;
+}
+
+void Config::set_memory_pool(size_t max_pooled) {
+  impl(this)->memory_pool_size = max_pooled;
+}
+
+void Config::set_store_pool(size_t max_pooled) {
+  impl(this)->store_pool_size = max_pooled;
+}
+
+void Config::set_heap_limits(size_t max_old_size, size_t max_young_size) {
+  impl(this)->heap_max_old_size = max_old_size;
+  impl(this)->heap_max_young_size = max_young_size;
+}
+
+void Config::set_perf_profiling(PerfProfiling profiling) {
+  impl(this)->perf_profiling = profiling;
+}
+
+
+// Code Cache
+
+// Compiled modules are cached on disk, one file per module binary, named by
+// the hash of the binary. A file holds a header, the binary itself, and the
+// serialized native module. A file is only used if it was written by the same
+// V8 build and flags, and contains the same binary. Files are mapped rather
+// than read, and the least recently used are evicted beyond the size limit.
+
+struct CodeCacheHeader {
+  char magic[8];
+  uint64_t build;
+  uint64_t binary_size;
+  uint64_t native_size;
+};
+
+static const char code_cache_magic[8] = {'w', 'a', 's', 'm', 'c', 'c', '0', '1'};
+static const char code_cache_suffix[] = ".wasmcache";
+
+class CodeCache {
+  std::string dir_;
+  size_t max_size_;
+  uint64_t build_;
+  std::mutex mutex_;
+
+  auto path(const vec<byte_t>& binary) const -> std::string {
+    static const char digits[] = "0123456789abcdef";
+    auto hash = hash_bytes(binary.get(), binary.size());
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) name[i] = digits[hash & 0xf];
+    return dir_ + "/" + name + code_cache_suffix;
+  }
+
+  void evict() {
+    if (max_size_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto dir = opendir(dir_.c_str());
+    if (!dir) return;
+
+    struct Entry { std::string path; size_t size; time_t mtime; };
+    std::vector<Entry> entries;
+    size_t total = 0;
+    static const size_t suffix_size = sizeof(code_cache_suffix) - 1;
+    while (auto entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.size() <= suffix_size ||
+          name.compare(name.size() - suffix_size, suffix_size,
+            code_cache_suffix) != 0) continue;
+      auto path = dir_ + "/" + name;
+      struct stat st;
+      if (stat(path.c_str(), &st) != 0) continue;
+      entries.push_back({path, size_t(st.st_size), st.st_mtime});
+      total += st.st_size;
+    }
+    closedir(dir);
+
+    if (total <= max_size_) return;
+    std::sort(entries.begin(), entries.end(),
+      [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+    for (auto& entry: entries) {
+      if (total <= max_size_) break;
+      if (unlink(entry.path.c_str()) == 0) total -= entry.size;
+    }
+  }
+
+public:
+  // A mapped cache file, unmapped when destroyed.
+  class Artifact {
+    void* base_;
+    size_t size_;
+
+  public:
+    Artifact(void* base = nullptr, size_t size = 0) : base_(base), size_(size) {}
+    Artifact(Artifact&& that) : base_(that.base_), size_(that.size_) {
+      that.base_ = nullptr;
+    }
+    ~Artifact() { if (base_) munmap(base_, size_); }
+
+    explicit operator bool() const { return base_ != nullptr; }
+
+    auto header() const -> const CodeCacheHeader* {
+      return static_cast<const CodeCacheHeader*>(base_);
+    }
+    auto binary() const -> const char* {
+      return reinterpret_cast<const char*>(header() + 1);
+    }
+    auto native() const -> const char* {
+      return binary() + header()->binary_size;
+    }
+  };
+
+  CodeCache(const std::string& dir, size_t max_size, uint64_t build) :
+    dir_(dir), max_size_(max_size), build_(build) {}
+
+  auto find(const vec<byte_t>& binary) -> Artifact {
+    auto fd = open(path(binary).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return Artifact();
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CodeCacheHeader)) {
+      close(fd);
+      return Artifact();
+    }
+    auto size = size_t(st.st_size);
+    auto base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base != MAP_FAILED) ignore(futimens(fd, nullptr));  // for LRU
+    close(fd);
+    if (base == MAP_FAILED) return Artifact();
+
+    Artifact artifact(base, size);
+    auto header = artifact.header();
+    if (std::memcmp(header->magic, code_cache_magic, sizeof(header->magic)) != 0 ||
+        header->build != build_ ||
+        header->binary_size != binary.size() ||
+        sizeof(CodeCacheHeader) + header->binary_size + header->native_size
+          != size ||
+        std::memcmp(artifact.binary(), binary.get(), binary.size()) != 0) {
+      return Artifact();
+    }
+    return artifact;
+  }
+
+  // Writes the file through a temporary and renames it into place, so that
+  // concurrent readers never see a partial file. The serialize function
+  // writes the native module directly into the mapped file.
+  template<class F>
+  void insert(const vec<byte_t>& binary, size_t native_size, F serialize) {
+    auto final_path = path(binary);
+    auto temp_path = final_path + ".XXXXXX";
+    auto fd = mkstemp(&temp_path[0]);
+    if (fd < 0) return;
+
+    auto size = sizeof(CodeCacheHeader) + binary.size() + native_size;
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+      base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+      unlink(temp_path.c_str());
+      return;
+    }
+
+    auto header = static_cast<CodeCacheHeader*>(base);
+    std::memcpy(header->magic, code_cache_magic, sizeof(header->magic));
+    header->build = build_;
+    header->binary_size = binary.size();
+    header->native_size = native_size;
+    auto ptr = reinterpret_cast<char*>(header + 1);
+    std::memcpy(ptr, binary.get(), binary.size());
+    auto success = serialize(ptr + binary.size(), native_size);
+    munmap(base, size);
+
+    if (!success || rename(temp_path.c_str(), final_path.c_str()) != 0) {
+      unlink(temp_path.c_str());
+      return;
+    }
+    evict();
+  }
+};
+
+
+// Module Cache
+
+// Compiled modules are also kept in memory, shared by all stores of the
+// engine. Entries are looked up by the hash of the binary and confirmed by
+// comparing the bytes, and evicted least recently used first.
+
+struct ModuleData;
+
+class ModuleCache {
+public:
+  struct Entry {
+    std::shared_ptr<void> native;
+    std::shared_ptr<ModuleData> data;
+
+    explicit operator bool() const { return native != nullptr; }
+  };
+
+private:
+  struct Item {
+    uint64_t hash;
+    std::string binary;
+    Entry entry;
+    size_t size;
+  };
+
+  size_t max_size_;
+  size_t size_ = 0;
+  std::mutex mutex_;
+  std::list<Item> items_;  // most recently used first
+  std::unordered_multimap<uint64_t, std::list<Item>::iterator> index_;
+  // Hashes of modules rejected as too large. A collision merely makes
+  // validation take the slower path, so the hash alone is good enough.
+  static const size_t max_oversized = 1024;
+  std::unordered_set<uint64_t> oversized_;
+
+  auto lookup(uint64_t hash, const vec<byte_t>& binary)
+    -> std::list<Item>::iterator {
+    auto range = index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      auto& item = *it->second;
+      if (item.binary.size() == binary.size() &&
+          std::memcmp(item.binary.data(), binary.get(), binary.size()) == 0) {
+        return it->second;
+      }
+    }
+    return items_.end();
+  }
+
+  void evict() {
+    while (size_ > max_size_ && !items_.empty()) {
+      auto last = std::prev(items_.end());
+      auto range = index_.equal_range(last->hash);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == last) { index_.erase(it); break; }
+      }
+      size_ -= last->size;
+      items_.erase(last);
+    }
+  }
+
+public:
+  explicit ModuleCache(size_t max_size) : max_size_(max_size) {}
+
+  auto find(const vec<byte_t>& binary) -> Entry {
+    auto hash = hash_bytes(binary.get(), binary.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = lookup(hash, binary);
+    if (it == items_.end()) return Entry();
+    items_.splice(items_.begin(), items_, it);
+    return it->entry;
+  }
+
+  auto oversized(const vec<byte_t>& binary) -> bool {
+    auto hash = hash_bytes(binary.get(), binary.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    return oversized_.count(hash) > 0;
+  }
+
+  void insert(const vec<byte_t>& binary, Entry&& entry) {
+    auto hash = hash_bytes(binary.get(), binary.size());
+    auto size = binary.size() + wasm_v8::module_native_size(entry.native);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size > max_size_) {
+      if (oversized_.size() >= max_oversized) oversized_.clear();
+      oversized_.insert(hash);
+      return;
+    }
+    if (lookup(hash, binary) != items_.end()) return;
+    items_.push_front(
+      {hash, std::string(binary.get(), binary.size()), std::move(entry), size});
+    index_.emplace(hash, items_.begin());
+    size_ += size;
+    evict();
+  }
+};
+
+
+// Memory Pool
+
+// Wasm memories are large reservations, mostly guard regions, that V8
+// obtains from the platform's page allocator. The pooling allocator keeps
+// freed reservations instead of unmapping them, discarding their pages so
+// that they read as zero again when touched, and hands them out again for
+// reservations of the same size.
+
+class PoolingPageAllocator : public v8::PageAllocator {
+  static const size_t min_pooled_size = size_t(1) << 30;
+
+  v8::PageAllocator* base_;
+  size_t max_pooled_;
+  std::mutex mutex_;
+  std::unordered_multimap<size_t, void*> pool_;
+
+public:
+  PoolingPageAllocator(v8::PageAllocator* base, size_t max_pooled) :
+    base_(base), max_pooled_(max_pooled) {}
+
+  ~PoolingPageAllocator() {
+    for (auto& entry: pool_) base_->FreePages(entry.second, entry.first);
+  }
+
+  auto AllocatePageSize() -> size_t override {
+    return base_->AllocatePageSize();
+  }
+  auto CommitPageSize() -> size_t override {
+    return base_->CommitPageSize();
+  }
+  void SetRandomMmapSeed(int64_t seed) override {
+    base_->SetRandomMmapSeed(seed);
+  }
+  auto GetRandomMmapAddr() -> void* override {
+    return base_->GetRandomMmapAddr();
+  }
+
+  auto AllocatePages(
+    void* hint, size_t size, size_t alignment, Permission access
+  ) -> void* override {
+    if (size >= min_pooled_size) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto range = pool_.equal_range(size);
+      for (auto it = range.first; it != range.second; ++it) {
+        auto address = it->second;
+        if (reinterpret_cast<uintptr_t>(address) % alignment != 0) continue;
+        if (!base_->SetPermissions(address, size, access)) continue;
+        pool_.erase(it);
+        return address;
+      }
+    }
+    return base_->AllocatePages(hint, size, alignment, access);
+  }
+
+  auto FreePages(void* address, size_t size) -> bool override {
+    if (size >= min_pooled_size) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Mapping fresh inaccessible pages over the range also drops any
+      // memory images mapped into it, which MADV_DONTNEED would restore.
+      if (pool_.size() < max_pooled_ &&
+          mmap(address, size, PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0)
+            != MAP_FAILED) {
+        pool_.emplace(size, address);
+        return true;
+      }
+    }
+    return base_->FreePages(address, size);
+  }
+
+  auto ReleasePages(void* address, size_t size, size_t new_size)
+    -> bool override {
+    return base_->ReleasePages(address, size, new_size);
+  }
+  auto SetPermissions(void* address, size_t size, Permission access)
+    -> bool override {
+    return base_->SetPermissions(address, size, access);
+  }
+  auto DiscardSystemPages(void* address, size_t size) -> bool override {
+    return base_->DiscardSystemPages(address, size);
+  }
+};
+
+// V8 takes its page allocator from the platform, so the pool is installed
+// by wrapping the default platform. Tasks still go to the default platform,
+// which therefore remains the one to pump.
+
+class PoolingPlatform : public v8::Platform {
+  v8::Platform* base_;
+  PoolingPageAllocator page_allocator_;
+
+public:
+  PoolingPlatform(v8::Platform* base, size_t max_pooled) :
+    base_(base), page_allocator_(base->GetPageAllocator(), max_pooled) {}
+
+  auto GetPageAllocator() -> v8::PageAllocator* override {
+    return &page_allocator_;
+  }
+
+  void OnCriticalMemoryPressure() override {
+    base_->OnCriticalMemoryPressure();
+  }
+  auto OnCriticalMemoryPressure(size_t size) -> bool override {
+    return base_->OnCriticalMemoryPressure(size);
+  }
+
+  auto NumberOfWorkerThreads() -> int override {
+    return base_->NumberOfWorkerThreads();
+  }
+  auto GetForegroundTaskRunner(v8::Isolate* isolate)
+    -> std::shared_ptr<v8::TaskRunner> override {
+    return base_->GetForegroundTaskRunner(isolate);
+  }
+  void CallOnWorkerThread(std::unique_ptr<v8::Task> task) override {
+    base_->CallOnWorkerThread(std::move(task));
+  }
+  void CallBlockingTaskOnWorkerThread(std::unique_ptr<v8::Task> task) override {
+    base_->CallBlockingTaskOnWorkerThread(std::move(task));
+  }
+  void CallDelayedOnWorkerThread(
+    std::unique_ptr<v8::Task> task, double delay
+  ) override {
+    base_->CallDelayedOnWorkerThread(std::move(task), delay);
+  }
+  void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override {
+    base_->CallOnForegroundThread(isolate, task);
+  }
+  void CallDelayedOnForegroundThread(
+    v8::Isolate* isolate, v8::Task* task, double delay
+  ) override {
+    base_->CallDelayedOnForegroundThread(isolate, task, delay);
+  }
+  void CallIdleOnForegroundThread(
+    v8::Isolate* isolate, v8::IdleTask* task
+  ) override {
+    base_->CallIdleOnForegroundThread(isolate, task);
+  }
+  auto IdleTasksEnabled(v8::Isolate* isolate) -> bool override {
+    return base_->IdleTasksEnabled(isolate);
+  }
+
+  auto MonotonicallyIncreasingTime() -> double override {
+    return base_->MonotonicallyIncreasingTime();
+  }
+  auto CurrentClockTimeMillis() -> double override {
+    return base_->CurrentClockTimeMillis();
+  }
+  auto GetStackTracePrinter() -> StackTracePrinter override {
+    return base_->GetStackTracePrinter();
+  }
+  auto GetTracingController() -> v8::TracingController* override {
+    return base_->GetTracingController();
+  }
+};
+
 
 // Engine
 
+struct StoreImpl;
+
 struct EngineImpl : Engine {
   static bool created;
 
   std::unique_ptr<v8::Platform> platform;
+  std::unique_ptr<PoolingPlatform> pooling_platform;
+  std::unique_ptr<CodeCache> code_cache;
+  std::unique_ptr<ModuleCache> module_cache;
+
+  size_t store_pool_size = 0;
+  std::mutex store_pool_mutex;
+  std::vector<StoreImpl*> store_pool;
+
+  size_t heap_max_old_size = 0;
+  size_t heap_max_young_size = 0;
+
+  // A single timer thread, started on demand, interrupts stores whose
+  // current call has run past its deadline.
+  std::mutex timer_mutex;
+  std::condition_variable timer_cv;
+  std::vector<StoreImpl*> timed_stores;
+  std::thread timer;
+  bool timer_stopping = false;
 
   EngineImpl() {
     assert(!created);
@@ -270,11 +823,11 @@ struct EngineImpl : Engine {
     stats.make(Stats::ENGINE, this);
   }
 
-  ~EngineImpl() {
-    v8::V8::Dispose();
-    v8::V8::ShutdownPlatform();
-    stats.free(Stats::ENGINE, this);
-  }
+  ~EngineImpl();
+
+  void add_timed_store(StoreImpl* store);
+  void remove_timed_store(StoreImpl* store);
+  void run_timer();
 };
 
 bool EngineImpl::created = false;
@@ -293,14 +846,73 @@ auto Engine::make(own<Config>&& config) -> own<Engine> {
   v8::internal::FLAG_experimental_wasm_anyref = true;
   v8::internal::FLAG_experimental_wasm_bulk_memory = true;
   v8::internal::FLAG_experimental_wasm_return_call = true;
+
+  auto config_impl = impl(config.get());
+  if (config_impl) {
+    auto tiering = config_impl->tiering;
+    v8::internal::FLAG_liftoff = tiering != Config::Tiering::OPTIMIZING;
+    v8::internal::FLAG_wasm_tier_up = tiering == Config::Tiering::TIERED;
+    v8::internal::FLAG_wasm_lazy_compilation = config_impl->lazy_compilation;
+    if (config_impl->compilation_threads > 0) {
+      v8::internal::FLAG_wasm_num_compilation_tasks =
+        static_cast<int>(config_impl->compilation_threads);
+    }
+    if (config_impl->max_code_space > 0) {
+      static const size_t MB = 1024 * 1024;
+      v8::internal::FLAG_wasm_max_code_space =
+        static_cast<unsigned int>((config_impl->max_code_space + MB - 1) / MB);
+    }
+    auto perf = config_impl->perf_profiling;
+    v8::internal::FLAG_perf_basic_prof =
+      perf == Config::PerfProfiling::PERF_MAP;
+    v8::internal::FLAG_perf_prof = perf == Config::PerfProfiling::JITDUMP;
+  }
+
   // v8::V8::SetFlagsFromCommandLine(&argc, const_cast<char**>(argv), false);
   auto engine = new(std::nothrow) EngineImpl;
   if (!engine) return own<Engine>();
   // v8::V8::InitializeICUDefaultLocation(argv[0]);
   // v8::V8::InitializeExternalStartupData(argv[0]);
-  engine->platform = v8::platform::NewDefaultPlatform();
-  v8::V8::InitializePlatform(engine->platform.get());
+  auto threads = config_impl ? config_impl->compilation_threads : 0;
+  engine->platform = v8::platform::NewDefaultPlatform(static_cast<int>(threads));
+  if (config_impl && config_impl->memory_pool_size > 0) {
+    engine->pooling_platform.reset(new(std::nothrow) PoolingPlatform(
+      engine->platform.get(), config_impl->memory_pool_size));
+  }
+  if (engine->pooling_platform) {
+    v8::V8::InitializePlatform(engine->pooling_platform.get());
+  } else {
+    v8::V8::InitializePlatform(engine->platform.get());
+  }
   v8::V8::Initialize();
+
+  if (config_impl) {
+    engine->store_pool_size = config_impl->store_pool_size;
+    engine->heap_max_old_size = config_impl->heap_max_old_size;
+    engine->heap_max_young_size = config_impl->heap_max_young_size;
+  }
+  if (config_impl && config_impl->module_cache_max_size > 0) {
+    engine->module_cache.reset(new(std::nothrow) ModuleCache(
+      config_impl->module_cache_max_size));
+  }
+  if (config_impl && !config_impl->code_cache_dir.empty()) {
+    // Cached code is specific to the V8 build and the flags above.
+    auto version = v8::V8::GetVersion();
+    auto build = hash_bytes(version, std::strlen(version));
+    bool flags[] = {
+      v8::internal::FLAG_experimental_wasm_bigint,
+      v8::internal::FLAG_experimental_wasm_mv,
+      v8::internal::FLAG_experimental_wasm_anyref,
+      v8::internal::FLAG_experimental_wasm_bulk_memory,
+      v8::internal::FLAG_experimental_wasm_return_call,
+      v8::internal::FLAG_liftoff,
+      v8::internal::FLAG_wasm_tier_up,
+      v8::internal::FLAG_wasm_lazy_compilation,
+    };
+    build = hash_bytes(flags, sizeof(flags), build);
+    engine->code_cache.reset(new(std::nothrow) CodeCache(
+      config_impl->code_cache_dir, config_impl->code_cache_max_size, build));
+  }
   return own<Engine>(engine);
 }
 
@@ -319,134 +931,838 @@ enum v8_symbol_t {
   V8_Y_COUNT
 };
 
+enum v8_private_t {
+  V8_P_MODULE_DATA, V8_P_INTERRUPTED,
+  V8_P_COUNT
+};
+
 enum v8_function_t {
-  V8_F_WEAKMAP, V8_F_WEAKMAP_PROTO, V8_F_WEAKMAP_GET, V8_F_WEAKMAP_SET,
   V8_F_MODULE, V8_F_GLOBAL, V8_F_TABLE, V8_F_MEMORY,
   V8_F_INSTANCE, V8_F_VALIDATE,
   V8_F_COUNT,
 };
 
-struct StoreImpl : Store {
-  friend own<Store> Store::make(Engine*);
+// Handle allocator for references. Handles live in page-sized slabs, and
+// free slots are threaded through a per-slab free list kept in the slots
+// themselves. A slab is found from its slots by address alignment, so at
+// most one empty slab is kept around when handles are released in bulk.
 
-  v8::Isolate::CreateParams create_params_;
-  v8::Isolate* isolate_;
-  v8::Eternal<v8::Context> context_;
-  v8::Eternal<v8::String> strings_[V8_S_COUNT];
-  v8::Eternal<v8::Symbol> symbols_[V8_Y_COUNT];
-  v8::Eternal<v8::Function> functions_[V8_F_COUNT];
-  v8::Eternal<v8::Object> host_data_map_;
-  v8::Eternal<v8::Symbol> callback_symbol_;
-  v8::Persistent<v8::Object>* handle_pool_ = nullptr;  // TODO: use v8::Value
+class HandlePool {
+  using Handle = v8::Persistent<v8::Object>;
 
-  StoreImpl() {
-    stats.make(Stats::STORE, this);
-  }
+  union Slot {
+    Slot* next;
+    typename std::aligned_storage<sizeof(Handle), alignof(Handle)>::type handle;
+  };
 
-  ~StoreImpl() {
-#ifdef WASM_API_DEBUG
-    isolate_->RequestGarbageCollectionForTesting(
-      v8::Isolate::kFullGarbageCollection);
-#endif
-    {
-      v8::HandleScope scope(isolate_);
-      while (handle_pool_ != nullptr) {
-        auto handle = handle_pool_;
-        handle_pool_ = reinterpret_cast<v8::Persistent<v8::Object>*>(
-          wasm_v8::foreign_get(handle->Get(isolate_)));
-        delete handle;
-      }
-    }
-    context()->Exit();
-    isolate_->Exit();
-    isolate_->Dispose();
-    delete create_params_.array_buffer_allocator;
-    stats.free(Stats::STORE, this);
+  static const size_t slab_size = 4096;
+
+  struct Slab {
+    Slab* prev;
+    Slab* next;
+    Slot* free;
+    size_t used;
+  };
+
+  static const size_t slab_slots = (slab_size - sizeof(Slab)) / sizeof(Slot);
+
+  // Every slab is on exactly one of the lists.
+  Slab* available_ = nullptr;  // slabs with free slots
+  Slab* full_ = nullptr;       // slabs without free slots
+  size_t empty_ = 0;           // empty slabs among the available ones
+
+  static auto slots(Slab* slab) -> Slot* {
+    return reinterpret_cast<Slot*>(slab + 1);
   }
 
-  auto isolate() const -> v8::Isolate* {
-    return isolate_;
+  static auto slab_of(void* handle) -> Slab* {
+    auto addr = reinterpret_cast<uintptr_t>(handle);
+    return reinterpret_cast<Slab*>(addr & ~(uintptr_t(slab_size) - 1));
   }
 
-  auto context() const -> v8::Local<v8::Context> {
-    return context_.Get(isolate_);
+  static void link(Slab*& list, Slab* slab) {
+    slab->prev = nullptr;
+    slab->next = list;
+    if (list) list->prev = slab;
+    list = slab;
   }
 
-  auto v8_string(v8_string_t i) const -> v8::Local<v8::String> {
-    return strings_[i].Get(isolate_);
+  static void unlink(Slab*& list, Slab* slab) {
+    if (slab->prev) slab->prev->next = slab->next; else list = slab->next;
+    if (slab->next) slab->next->prev = slab->prev;
   }
-  auto v8_string(v8_symbol_t i) const -> v8::Local<v8::Symbol> {
-    return symbols_[i].Get(isolate_);
+
+  static void free_slabs(Slab* list) {
+    while (list) {
+      auto slab = list;
+      list = slab->next;
+      std::free(slab);
+    }
   }
-  auto v8_function(v8_function_t i) const -> v8::Local<v8::Function> {
-    return functions_[i].Get(isolate_);
+
+  auto new_slab() -> Slab* {
+    void* mem;
+    if (posix_memalign(&mem, slab_size, slab_size) != 0) return nullptr;
+    auto slab = static_cast<Slab*>(mem);
+    auto slot = slots(slab);
+    for (size_t i = 0; i < slab_slots - 1; ++i) slot[i].next = &slot[i + 1];
+    slot[slab_slots - 1].next = nullptr;
+    slab->free = slot;
+    slab->used = 0;
+    link(available_, slab);
+    ++empty_;
+    return slab;
   }
 
-  auto host_data_map() const -> v8::Local<v8::Object> {
-    return host_data_map_.Get(isolate_);
+public:
+  HandlePool() = default;
+  HandlePool(const HandlePool&) = delete;
+  HandlePool& operator=(const HandlePool&) = delete;
+
+  ~HandlePool() {
+    free_slabs(available_);
+    free_slabs(full_);
   }
 
-  static auto get(v8::Isolate* isolate) -> StoreImpl* {
-    return static_cast<StoreImpl*>(isolate->GetData(0));
+  auto make() -> Handle* {
+    if (!available_ && !new_slab()) return nullptr;
+    auto slab = available_;
+    auto slot = slab->free;
+    slab->free = slot->next;
+    if (slab->used++ == 0) --empty_;
+    if (!slab->free) {
+      unlink(available_, slab);
+      link(full_, slab);
+    }
+    return new(&slot->handle) Handle();
   }
 
-  auto make_handle() -> v8::Persistent<v8::Object>* {
-    if (handle_pool_ == nullptr) {
-      static const size_t n = 100;
-      for (size_t i = 0; i < n; ++i) {
-        auto v8_next = wasm_v8::foreign_new(isolate_, handle_pool_);
-        handle_pool_ = new(std::nothrow) v8::Persistent<v8::Object>();
-        if (!handle_pool_) return nullptr;
-        handle_pool_->Reset(isolate_, v8::Local<v8::Object>::Cast(v8_next));
-      }
+  // The handle must have been reset.
+  void free(Handle* handle) {
+    auto slab = slab_of(handle);
+    auto slot = reinterpret_cast<Slot*>(handle);
+    if (!slab->free) {
+      unlink(full_, slab);
+      link(available_, slab);
+    }
+    slot->next = slab->free;
+    slab->free = slot;
+    if (--slab->used > 0) return;
+    if (empty_ == 0) {
+      ++empty_;
+    } else {
+      unlink(available_, slab);
+      std::free(slab);
     }
-    auto handle = handle_pool_;
-    handle_pool_ = reinterpret_cast<v8::Persistent<v8::Object>*>(
-      wasm_v8::foreign_get(handle->Get(isolate_)));
-    return handle;
   }
+};
 
-  void free_handle(v8::Persistent<v8::Object>* handle) {
-    // TODO: shrink pool?
-    auto next = wasm_v8::foreign_new(isolate_, handle_pool_);
-    handle->Reset(isolate_, v8::Local<v8::Object>::Cast(next));
-    handle_pool_ = handle;
+
+// Host info attached to a JS object, held weakly.
+struct HostInfo {
+  v8::Global<v8::Object> object;
+  int hash;
+  void* info = nullptr;
+  void (*finalizer)(void*) = nullptr;
+};
+
+
+// Runtime metrics. A store is only ever updated by the thread running it,
+// so counters are single-writer atomics: updates are plain relaxed loads
+// and stores, and other threads can read them without tearing.
+class Counter {
+  std::atomic<uint64_t> value_{0};
+
+public:
+  void add(uint64_t n = 1) {
+    value_.store(value_.load(std::memory_order_relaxed) + n,
+      std::memory_order_relaxed);
+  }
+  void reset() { value_.store(0, std::memory_order_relaxed); }
+  auto get() const -> uint64_t {
+    return value_.load(std::memory_order_relaxed);
   }
 };
 
-template<> struct implement<Store> { using type = StoreImpl; };
+class Histogram {
+  static const size_t size = Store::Metrics::histogram_size;
+  Counter buckets_[size];
 
+public:
+  void record(uint64_t ns) {
+    size_t i = ns < 2 ? 0 : 63 - __builtin_clzll(ns);
+    buckets_[i < size ? i : size - 1].add();
+  }
+  void reset() { for (auto& bucket: buckets_) bucket.reset(); }
+  auto read(uint64_t out[]) const -> uint64_t {
+    uint64_t total = 0;
+    for (size_t i = 0; i < size; ++i) total += out[i] = buckets_[i].get();
+    return total;
+  }
+};
 
-void Store::destroy() {
-  delete impl(this);
+struct StoreMetrics {
+  Histogram guest_calls;
+  Histogram host_calls;
+  Counter compilations, compile_ns;
+  Counter deserializations, deserialize_ns;
+  Counter instantiations, instantiate_ns;
+
+  void reset() {
+    guest_calls.reset(); host_calls.reset();
+    compilations.reset(); compile_ns.reset();
+    deserializations.reset(); deserialize_ns.reset();
+    instantiations.reset(); instantiate_ns.reset();
+  }
+};
+
+inline auto now_ns() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-auto Store::make(Engine*) -> own<Store> {
-  auto store = own<StoreImpl>(new(std::nothrow) StoreImpl());
-  if (!store) return own<Store>();
 
-  // Create isolate.
-  store->create_params_.array_buffer_allocator =
-    v8::ArrayBuffer::Allocator::NewDefaultAllocator();
-  auto isolate = v8::Isolate::New(store->create_params_);
-  if (!isolate) return own<Store>();
+// Sampled stacks. Instances are recorded once per profile and referred to
+// by index from the frames.
+struct ProfileFrame {
+  uint32_t instance;
+  uint32_t func_index;
+  uint32_t func_offset;
+  uint32_t module_offset;
+};
 
-  {
-    v8::Isolate::Scope isolate_scope(isolate);
-    v8::HandleScope handle_scope(isolate);
+struct ProfileImpl : Store::Profile {
+  static const size_t max_depth = 64;
 
-    // Create context.
-    auto context = v8::Context::New(isolate);
-    if (context.IsEmpty()) return own<Store>();
-    v8::Context::Scope context_scope(context);
+  StoreImpl* store;
+  std::vector<v8::Global<v8::Object>> instances;
+  std::vector<ProfileFrame> frames;
+  std::vector<size_t> starts;  // first frame of each sample
 
-    store->isolate_ = isolate;
-    store->context_ = v8::Eternal<v8::Context>(isolate, context);
+  explicit ProfileImpl(StoreImpl* store) : store(store) {
+    stats.make(Stats::STORE_PROFILE, this);
+  }
 
-    // Create strings.
-    static const char* const raw_strings[V8_S_COUNT] = {
-      "",
-      "i32", "i64", "f32", "f64", "anyref", "anyfunc", 
+  ~ProfileImpl() {
+    stats.free(Stats::STORE_PROFILE, this);
+  }
+
+  auto instance_index(v8::Isolate* isolate, v8::Local<v8::Object> instance)
+  -> uint32_t {
+    for (size_t i = instances.size(); i-- > 0;) {
+      if (instances[i] == instance) return static_cast<uint32_t>(i);
+    }
+    instances.emplace_back(isolate, instance);
+    return static_cast<uint32_t>(instances.size() - 1);
+  }
+
+  void record(v8::Isolate* isolate) {
+    v8::HandleScope handle_scope(isolate);
+    wasm_v8::stack_frame_t stack[max_depth];
+    auto depth = wasm_v8::stack_frames(isolate, stack, max_depth);
+    if (depth == 0) return;
+    starts.push_back(frames.size());
+    for (size_t i = 0; i < depth; ++i) {
+      frames.push_back({instance_index(isolate, stack[i].instance),
+        stack[i].func_index, stack[i].func_offset, stack[i].module_offset});
+    }
+  }
+};
+
+template<> struct implement<Store::Profile> { using type = ProfileImpl; };
+
+
+struct AsyncCompilation {
+  std::shared_ptr<void> job;
+  Module::async_callback callback;
+  void* env;
+
+  AsyncCompilation(v8::Local<v8::Context> context, Module::async_callback callback, void* env) :
+    job(wasm_v8::compile_start(context)), callback(callback), env(env) {}
+};
+
+struct StoreImpl : Store {
+  friend own<Store> Store::make(Engine*);
+
+  static const uint32_t default_trace_depth = 10;  // V8's default
+
+  EngineImpl* engine_;
+  v8::Isolate::CreateParams create_params_;
+  v8::Isolate* isolate_ = nullptr;
+  std::unique_ptr<v8::Locker> locker_;  // held while entered
+  bool built_ = false;  // set once Store::make has succeeded
+  bool entered_ = false;
+  size_t memory_epoch_ = 0;
+  std::atomic<int64_t> external_memory_{0};  // sampled by memory_may_grow
+  std::mutex interrupt_mutex_;  // taken by interrupting threads only
+  std::atomic<size_t> executing_{0};  // nesting depth of calls into Wasm
+  std::atomic<bool> interrupt_requested_{false};
+  std::atomic<uint32_t> timeout_{0};  // in milliseconds, 0 for none
+  std::atomic<int64_t> deadline_{0};  // in steady clock ticks, 0 for none
+  heap_limit_callback heap_limit_callback_ = nullptr;
+  void* heap_limit_env_ = nullptr;
+  uint32_t trace_depth_ = default_trace_depth;
+  v8::Eternal<v8::Context> context_;
+  v8::Eternal<v8::String> strings_[V8_S_COUNT];
+  v8::Eternal<v8::Symbol> symbols_[V8_Y_COUNT];
+  v8::Eternal<v8::Private> privates_[V8_P_COUNT];
+  v8::Eternal<v8::Function> functions_[V8_F_COUNT];
+  std::unordered_multimap<int, HostInfo> host_infos_;
+  HostInfo* last_host_info_ = nullptr;
+  v8::Eternal<v8::Symbol> callback_symbol_;
+  HandlePool handle_pool_;
+  std::atomic<size_t> live_handles_{0};
+  StoreMetrics metrics_;
+  std::unique_ptr<ProfileImpl> profile_;
+  std::thread sampler_;
+  std::mutex sampler_mutex_;
+  std::condition_variable sampler_cv_;
+  bool sampler_stopping_ = false;
+  bool sample_pending_ = false;  // guarded by interrupt_mutex_
+  std::unordered_map<std::string, v8::Eternal<v8::Object>> wrapper_modules_;
+  std::vector<std::unique_ptr<AsyncCompilation>> async_compilations_;
+  std::shared_ptr<void> entry_cache_;  // created by the first direct call
+
+  StoreImpl() {
+    stats.make(Stats::STORE, this);
+  }
+
+  ~StoreImpl() {
+    stop_profiling();
+    if (timeout_ > 0) engine_->remove_timed_store(this);
+    if (built_) {
+      if (!entered_) enter();
+      abort_async_compilations();
+#ifdef WASM_API_DEBUG
+      isolate_->RequestGarbageCollectionForTesting(
+        v8::Isolate::kFullGarbageCollection);
+#endif
+      clear_host_infos();
+      entry_cache_.reset();
+      exit();
+    }
+    // A store that failed to build may still hold the lock.
+    locker_.reset();
+    if (isolate_) isolate_->Dispose();
+    delete create_params_.array_buffer_allocator;
+    stats.free(Stats::STORE, this);
+  }
+
+  // Isolates are entered by the thread using the store. A pooled store can
+  // be picked up by a different thread, so it is exited while pooled, and
+  // locked while entered: taking the lock on a new thread is what sets up
+  // V8's per-thread state for it, such as the stack limit.
+  void enter() {
+    assert(!entered_);
+    if (!locker_) locker_.reset(new v8::Locker(isolate_));
+    isolate_->Enter();
+    v8::HandleScope handle_scope(isolate_);
+    context()->Enter();
+    entered_ = true;
+  }
+
+  void exit() {
+    assert(entered_);
+    {
+      v8::HandleScope handle_scope(isolate_);
+      context()->Exit();
+    }
+    isolate_->Exit();
+    locker_.reset();
+    entered_ = false;
+  }
+
+  void clear_host_infos() {
+    for (auto& entry: host_infos_) {
+      auto& host_info = entry.second;
+      host_info.object.Reset();
+      if (host_info.finalizer) host_info.finalizer(host_info.info);
+    }
+    host_infos_.clear();
+    last_host_info_ = nullptr;
+  }
+
+  void abort_async_compilations() {
+    v8::HandleScope handle_scope(isolate_);
+    for (auto& compilation: async_compilations_) {
+      wasm_v8::compile_abort(compilation->job);
+      compilation->callback(compilation->env, own<Module>());
+    }
+    async_compilations_.clear();
+  }
+
+  // Prepares the store for reuse by a later Store::make. All references
+  // into the store are gone at this point, so nothing from the previous
+  // user is reachable; garbage is left to V8's next collection. Host info
+  // finalizers run right away, as they would on destruction, rather than
+  // whenever the next user's session triggers that collection.
+  void reset() {
+    set_timeout(0);
+    set_heap_limit_callback(nullptr, nullptr);
+    set_trace_depth(default_trace_depth);
+    stop_profiling();
+    abort_async_compilations();
+    clear_host_infos();
+    metrics_.reset();
+#ifdef WASM_API_DEBUG
+    isolate_->RequestGarbageCollectionForTesting(
+      v8::Isolate::kFullGarbageCollection);
+#endif
+    exit();
+  }
+
+  // Interruption terminates V8 execution, but only while a call is running,
+  // so that a late request cannot hit the next call. Termination is
+  // cancelled once the outermost call has returned. The request is flagged
+  // before the running call is checked, and the call is ended before the
+  // flag is checked, so one of the two sides always sees the other; the
+  // call path only takes the mutex when an interrupt actually came in.
+  void interrupt() {
+    std::lock_guard<std::mutex> lock(interrupt_mutex_);
+    interrupt_requested_.store(true);
+    if (executing_.load() == 0) {
+      interrupt_requested_.store(false);
+      return;
+    }
+    isolate_->TerminateExecution();
+  }
+
+  void enter_wasm() {
+    if (executing_.fetch_add(1) > 0) return;
+    auto timeout = timeout_.load(std::memory_order_relaxed);
+    if (timeout > 0) {
+      auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(timeout);
+      deadline_.store(deadline.time_since_epoch().count(),
+        std::memory_order_relaxed);
+    }
+  }
+
+  void exit_wasm() {
+    if (executing_.fetch_sub(1) > 1) return;
+    deadline_.store(0, std::memory_order_relaxed);
+    if (interrupt_requested_.load()) {
+      std::lock_guard<std::mutex> lock(interrupt_mutex_);
+      if (interrupt_requested_.load()) {
+        isolate_->CancelTerminateExecution();
+        interrupt_requested_.store(false);
+      }
+    }
+  }
+
+  void set_timeout(uint32_t ms) {
+    auto old_ms = timeout_.exchange(ms, std::memory_order_relaxed);
+    if (ms > 0) engine_->add_timed_store(this);
+    else if (old_ms > 0) engine_->remove_timed_store(this);
+  }
+
+  void collect_garbage(Collection collection) {
+    isolate_->RequestGarbageCollectionForTesting(
+      collection == Collection::MINOR
+        ? v8::Isolate::kMinorGarbageCollection
+        : v8::Isolate::kFullGarbageCollection);
+  }
+
+  auto notify_idle(uint32_t ms) -> bool {
+    auto platform = engine_->platform.get();
+    return isolate_->IdleNotificationDeadline(
+      platform->MonotonicallyIncreasingTime() + ms / 1000.0);
+  }
+
+  void set_heap_limit_callback(heap_limit_callback callback, void* env) {
+    if (heap_limit_callback_) {
+      isolate_->RemoveNearHeapLimitCallback(&StoreImpl::near_heap_limit, 0);
+    }
+    heap_limit_callback_ = callback;
+    heap_limit_env_ = env;
+    if (callback) {
+      isolate_->AddNearHeapLimitCallback(&StoreImpl::near_heap_limit, this);
+    }
+  }
+
+  // V8 captures the raw frames of errors up to Error.stackTraceLimit, which
+  // is per context, and formats them only when the stack is accessed.
+  void set_trace_depth(uint32_t depth) {
+    if (depth == trace_depth_) return;
+    v8::HandleScope handle_scope(isolate_);
+    auto context = this->context();
+    auto error_name = v8::String::NewFromUtf8(isolate_, "Error",
+      v8::NewStringType::kNormal).ToLocalChecked();
+    auto limit_name = v8::String::NewFromUtf8(isolate_, "stackTraceLimit",
+      v8::NewStringType::kNormal).ToLocalChecked();
+    auto maybe_error = context->Global()->Get(context, error_name);
+    if (maybe_error.IsEmpty() || !maybe_error.ToLocalChecked()->IsObject()) return;
+    auto error = v8::Local<v8::Object>::Cast(maybe_error.ToLocalChecked());
+    if (error->Set(context, limit_name,
+          v8::Integer::NewFromUnsigned(isolate_, depth)).FromMaybe(false)) {
+      trace_depth_ = depth;
+    }
+  }
+
+  static auto near_heap_limit(
+    void* data, size_t current_limit, size_t initial_limit
+  ) -> size_t {
+    auto store = static_cast<StoreImpl*>(data);
+    return store->heap_limit_callback_(
+      store->heap_limit_env_, current_limit, initial_limit);
+  }
+
+  // Called by the timer thread, returns when to check again. A call that
+  // starts later gets its deadline no earlier than the timeout from now.
+  auto check_deadline(std::chrono::steady_clock::time_point now)
+    -> std::chrono::steady_clock::time_point {
+    auto deadline = deadline_.load(std::memory_order_relaxed);
+    auto timeout = std::chrono::milliseconds(
+      timeout_.load(std::memory_order_relaxed));
+    auto next = timeout.count() > 0
+      ? now + timeout : std::chrono::steady_clock::time_point::max();
+    if (deadline == 0) return next;
+    auto deadline_time = std::chrono::steady_clock::time_point(
+      std::chrono::steady_clock::duration(deadline));
+    if (now < deadline_time) return deadline_time;
+    if (deadline_.compare_exchange_strong(deadline, 0)) interrupt();
+    return next;
+  }
+
+  // The sampler thread asks for an interrupt while Wasm code is running,
+  // and the stack is then recorded on the store's own thread.
+  auto start_profiling(uint32_t interval_us) -> bool {
+    if (profile_) return false;
+    profile_.reset(new(std::nothrow) ProfileImpl(this));
+    if (!profile_) return false;
+    sampler_ = std::thread(&StoreImpl::run_sampler, this,
+      std::chrono::microseconds(interval_us > 0 ? interval_us : 1));
+    return true;
+  }
+
+  auto stop_profiling() -> own<Store::Profile> {
+    if (!profile_) return own<Store::Profile>();
+    {
+      std::lock_guard<std::mutex> lock(sampler_mutex_);
+      sampler_stopping_ = true;
+    }
+    sampler_cv_.notify_one();
+    sampler_.join();
+    sampler_stopping_ = false;
+    return own<Store::Profile>(profile_.release());
+  }
+
+  void run_sampler(std::chrono::microseconds interval) {
+    std::unique_lock<std::mutex> lock(sampler_mutex_);
+    while (!sampler_cv_.wait_for(lock, interval,
+             [this] { return sampler_stopping_; })) {
+      std::lock_guard<std::mutex> interrupt_lock(interrupt_mutex_);
+      if (executing_.load() == 0 || sample_pending_) continue;
+      sample_pending_ = true;
+      isolate_->RequestInterrupt(&StoreImpl::sample, this);
+    }
+  }
+
+  static void sample(v8::Isolate* isolate, void* data) {
+    auto store = static_cast<StoreImpl*>(data);
+    {
+      std::lock_guard<std::mutex> lock(store->interrupt_mutex_);
+      store->sample_pending_ = false;
+    }
+    if (store->profile_) store->profile_->record(isolate);
+  }
+
+  auto entry_cache() -> const std::shared_ptr<void>& {
+    if (!entry_cache_) entry_cache_ = wasm_v8::entry_cache_new();
+    return entry_cache_;
+  }
+
+  // Bumped whenever memories may have grown, invalidating memory views.
+  // V8's external memory counter is not atomic, so it is sampled here, on
+  // the store's thread, for metrics read from other threads.
+  auto memory_epoch() const -> size_t {
+    return memory_epoch_;
+  }
+  void memory_may_grow() {
+    ++memory_epoch_;
+    external_memory_.store(wasm_v8::isolate_external_memory(isolate_),
+      std::memory_order_relaxed);
+  }
+
+  auto external_memory() const -> int64_t {
+    return external_memory_.load(std::memory_order_relaxed);
+  }
+
+  auto engine() const -> EngineImpl* {
+    return engine_;
+  }
+
+  auto metrics() -> StoreMetrics& {
+    return metrics_;
+  }
+
+  auto metrics() const -> const StoreMetrics& {
+    return metrics_;
+  }
+
+  auto live_handles() const -> size_t {
+    return live_handles_.load(std::memory_order_relaxed);
+  }
+
+  auto isolate() const -> v8::Isolate* {
+    return isolate_;
+  }
+
+  auto context() const -> v8::Local<v8::Context> {
+    return context_.Get(isolate_);
+  }
+
+  auto v8_string(v8_string_t i) const -> v8::Local<v8::String> {
+    return strings_[i].Get(isolate_);
+  }
+  auto v8_string(v8_symbol_t i) const -> v8::Local<v8::Symbol> {
+    return symbols_[i].Get(isolate_);
+  }
+  auto v8_private(v8_private_t i) const -> v8::Local<v8::Private> {
+    return privates_[i].Get(isolate_);
+  }
+  auto v8_function(v8_function_t i) const -> v8::Local<v8::Function> {
+    return functions_[i].Get(isolate_);
+  }
+
+  // Host info lives in a native side table keyed by identity hash,
+  // with the last hit cached for repeated lookups of the same object.
+  auto find_host_info(v8::Local<v8::Object> obj) -> HostInfo* {
+    if (last_host_info_ && last_host_info_->object == obj) {
+      return last_host_info_;
+    }
+    auto range = host_infos_.equal_range(obj->GetIdentityHash());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.object == obj) return last_host_info_ = &it->second;
+    }
+    return nullptr;
+  }
+
+  void set_host_info(
+    v8::Local<v8::Object> obj, void* info, void (*finalizer)(void*)
+  ) {
+    auto host_info = find_host_info(obj);
+    if (host_info) {
+      if (host_info->finalizer) host_info->finalizer(host_info->info);
+    } else {
+      auto hash = obj->GetIdentityHash();
+      host_info = &host_infos_.emplace(hash, HostInfo())->second;
+      host_info->hash = hash;
+      host_info->object.Reset(isolate_, obj);
+      host_info->object.SetWeak(
+        host_info, &finalize_host_info, v8::WeakCallbackType::kParameter);
+      last_host_info_ = host_info;
+    }
+    host_info->info = info;
+    host_info->finalizer = finalizer;
+  }
+
+  static void finalize_host_info(const v8::WeakCallbackInfo<HostInfo>& data) {
+    auto host_info = data.GetParameter();
+    StoreImpl::get(data.GetIsolate())->erase_host_info(host_info);
+  }
+
+  void erase_host_info(HostInfo* host_info) {
+    if (last_host_info_ == host_info) last_host_info_ = nullptr;
+    host_info->object.Reset();
+    if (host_info->finalizer) host_info->finalizer(host_info->info);
+    auto range = host_infos_.equal_range(host_info->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (&it->second == host_info) {
+        host_infos_.erase(it);
+        return;
+      }
+    }
+  }
+
+  static auto get(v8::Isolate* isolate) -> StoreImpl* {
+    return static_cast<StoreImpl*>(isolate->GetData(0));
+  }
+
+  // Runs the foreground tasks that V8 posted for this store, such as the
+  // completion of a background compilation, optionally waiting for one.
+  void run_tasks(bool wait) {
+    auto platform = engine_->platform.get();
+    if (wait) {
+      v8::platform::PumpMessageLoop(platform, isolate_,
+        v8::platform::MessageLoopBehavior::kWaitForWork);
+    }
+    while (v8::platform::PumpMessageLoop(platform, isolate_)) {}
+    isolate_->RunMicrotasks();
+  }
+
+  // Wrapper modules only depend on the signature they wrap,
+  // so compile each one once and keep it for the store's lifetime.
+  auto wrapper_module(const vec<byte_t>& binary)
+    -> v8::MaybeLocal<v8::Object> {
+    std::string key(binary.get(), binary.size());
+    auto it = wrapper_modules_.find(key);
+    if (it != wrapper_modules_.end()) return it->second.Get(isolate_);
+
+    auto array_buffer = v8::ArrayBuffer::New(
+      isolate_, const_cast<byte_t*>(binary.get()), binary.size());
+    v8::Local<v8::Value> args[] = {array_buffer};
+    auto maybe_obj =
+      v8_function(V8_F_MODULE)->NewInstance(context(), 1, args);
+    if (maybe_obj.IsEmpty()) return maybe_obj;
+    auto obj = maybe_obj.ToLocalChecked();
+    wrapper_modules_.emplace(
+      std::move(key), v8::Eternal<v8::Object>(isolate_, obj));
+    return obj;
+  }
+
+  auto make_handle() -> v8::Persistent<v8::Object>* {
+    auto handle = handle_pool_.make();
+    if (handle) {
+      live_handles_.store(live_handles() + 1, std::memory_order_relaxed);
+    }
+    return handle;
+  }
+
+  void free_handle(v8::Persistent<v8::Object>* handle) {
+    handle->Reset();
+    handle_pool_.free(handle);
+    live_handles_.store(live_handles() - 1, std::memory_order_relaxed);
+  }
+};
+
+template<> struct implement<Store> { using type = StoreImpl; };
+
+
+// Marks a call into Wasm, which can be interrupted while it lasts.
+class ExecutionScope {
+  StoreImpl* store_;
+public:
+  explicit ExecutionScope(StoreImpl* store) : store_(store) {
+    store_->enter_wasm();
+  }
+  ~ExecutionScope() { store_->exit_wasm(); }
+};
+
+
+// Adding a store again wakes the timer to pick up its new timeout.
+void EngineImpl::add_timed_store(StoreImpl* store) {
+  std::lock_guard<std::mutex> lock(timer_mutex);
+  auto it = std::find(timed_stores.begin(), timed_stores.end(), store);
+  if (it == timed_stores.end()) timed_stores.push_back(store);
+  if (!timer.joinable()) timer = std::thread(&EngineImpl::run_timer, this);
+  timer_cv.notify_one();
+}
+
+void EngineImpl::remove_timed_store(StoreImpl* store) {
+  std::lock_guard<std::mutex> lock(timer_mutex);
+  timed_stores.erase(
+    std::remove(timed_stores.begin(), timed_stores.end(), store),
+    timed_stores.end());
+}
+
+// Sleeps until the earliest time at which some store's deadline can expire.
+void EngineImpl::run_timer() {
+  std::unique_lock<std::mutex> lock(timer_mutex);
+  while (!timer_stopping) {
+    if (timed_stores.empty()) {
+      timer_cv.wait(lock);
+      continue;
+    }
+    auto now = std::chrono::steady_clock::now();
+    auto wake = std::chrono::steady_clock::time_point::max();
+    for (auto store: timed_stores) {
+      wake = std::min(wake, store->check_deadline(now));
+    }
+    if (wake == std::chrono::steady_clock::time_point::max()) {
+      timer_cv.wait(lock);
+    } else {
+      timer_cv.wait_until(lock, wake);
+    }
+  }
+}
+
+EngineImpl::~EngineImpl() {
+  if (timer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(timer_mutex);
+      timer_stopping = true;
+    }
+    timer_cv.notify_one();
+    timer.join();
+  }
+  for (auto store: store_pool) delete store;
+  // Cached native modules must go before the Wasm engine is torn down.
+  module_cache.reset();
+  code_cache.reset();
+  v8::V8::Dispose();
+  v8::V8::ShutdownPlatform();
+  stats.free(Stats::ENGINE, this);
+}
+
+
+void Store::destroy() {
+  auto store = impl(this);
+  auto engine = store->engine();
+  // Resetting runs callbacks and a collection, so it is done unlocked;
+  // the pool may fill up meanwhile, in which case the store is dropped.
+  // Stores that failed to build are never pooled.
+  if (store->built_ && engine->store_pool_size > 0) {
+    store->reset();
+    std::lock_guard<std::mutex> lock(engine->store_pool_mutex);
+    if (engine->store_pool.size() < engine->store_pool_size) {
+      engine->store_pool.push_back(store);
+      return;
+    }
+  }
+  delete store;
+}
+
+auto Store::make(Engine* engine_abs) -> own<Store> {
+  auto engine = impl(engine_abs);
+  if (engine->store_pool_size > 0) {
+    std::unique_lock<std::mutex> lock(engine->store_pool_mutex);
+    if (!engine->store_pool.empty()) {
+      auto store = engine->store_pool.back();
+      engine->store_pool.pop_back();
+      lock.unlock();
+      store->enter();
+      return own<Store>(store);
+    }
+  }
+
+  auto store = own<StoreImpl>(new(std::nothrow) StoreImpl());
+  if (!store) return own<Store>();
+  store->engine_ = engine;
+
+  // Create isolate.
+  store->create_params_.array_buffer_allocator =
+    v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+  auto& constraints = store->create_params_.constraints;
+  if (engine->heap_max_old_size > 0) {
+    constraints.set_max_old_space_size(
+      std::max<size_t>(engine->heap_max_old_size >> 20, 1));
+  }
+  if (engine->heap_max_young_size > 0) {
+    // The young generation consists of three semi-spaces.
+    constraints.set_max_semi_space_size_in_kb(
+      std::max<size_t>(engine->heap_max_young_size / 3 >> 10, 1));
+  }
+  auto isolate = v8::Isolate::New(store->create_params_);
+  if (!isolate) return own<Store>();
+  store->isolate_ = isolate;
+  store->locker_.reset(new v8::Locker(isolate));
+
+  {
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+
+    // Create context.
+    auto context = v8::Context::New(isolate);
+    if (context.IsEmpty()) return own<Store>();
+    v8::Context::Scope context_scope(context);
+
+    store->context_ = v8::Eternal<v8::Context>(isolate, context);
+
+    // Create strings.
+    static const char* const raw_strings[V8_S_COUNT] = {
+      "",
+      "i32", "i64", "f32", "f64", "anyref", "anyfunc", 
       "value", "mutable", "element", "initial", "maximum",
     };
     for (int i = 0; i < V8_S_COUNT; ++i) {
@@ -462,6 +1778,11 @@ auto Store::make(Engine*) -> own<Store> {
       store->symbols_[i] = v8::Eternal<v8::Symbol>(isolate, symbol);
     }
 
+    for (int i = 0; i < V8_P_COUNT; ++i) {
+      auto priv = v8::Private::New(isolate);
+      store->privates_[i] = v8::Eternal<v8::Private>(isolate, priv);
+    }
+
     // Extract functions.
     auto global = context->Global();
     auto maybe_wasm_name = v8::String::NewFromUtf8(isolate, "WebAssembly",
@@ -471,15 +1792,11 @@ auto Store::make(Engine*) -> own<Store> {
     auto maybe_wasm = global->Get(context, wasm_name);
     if (maybe_wasm.IsEmpty()) return own<Store>();
     auto wasm = v8::Local<v8::Object>::Cast(maybe_wasm.ToLocalChecked());
-    v8::Local<v8::Object> weakmap;
-    v8::Local<v8::Object> weakmap_proto;
 
     struct {
       const char* name;
       v8::Local<v8::Object>* carrier;
     } raw_functions[V8_F_COUNT] = {
-      {"WeakMap", &global}, {"prototype", &weakmap},
-      {"get", &weakmap_proto}, {"set", &weakmap_proto},
       {"Module", &wasm}, {"Global", &wasm}, {"Table", &wasm}, {"Memory", &wasm},
       {"Instance", &wasm}, {"validate", &wasm},
     };
@@ -494,30 +1811,15 @@ auto Store::make(Engine*) -> own<Store> {
       auto maybe_obj = (*raw_functions[i].carrier)->Get(context, name);
       if (maybe_obj.IsEmpty()) return own<Store>();
       auto obj = v8::Local<v8::Object>::Cast(maybe_obj.ToLocalChecked());
-      if (i == V8_F_WEAKMAP_PROTO) {
-        assert(obj->IsObject());
-        weakmap_proto = obj;
-      } else {
-        assert(obj->IsFunction());
-        auto function = v8::Local<v8::Function>::Cast(obj);
-        store->functions_[i] = v8::Eternal<v8::Function>(isolate, function);
-        if (i == V8_F_WEAKMAP) weakmap = function;
-      }
+      assert(obj->IsFunction());
+      auto function = v8::Local<v8::Function>::Cast(obj);
+      store->functions_[i] = v8::Eternal<v8::Function>(isolate, function);
     }
-
-    // Create host data weak map.
-    v8::Local<v8::Value> empty_args[] = {};
-    auto maybe_weakmap =
-      store->v8_function(V8_F_WEAKMAP)->NewInstance(context, 0, empty_args);
-    if (maybe_weakmap.IsEmpty()) return own<Store>();
-    auto map = v8::Local<v8::Object>::Cast(maybe_weakmap.ToLocalChecked());
-    assert(map->IsWeakMap());
-    store->host_data_map_ = v8::Eternal<v8::Object>(isolate, map);
   }
 
-  store->isolate()->Enter();
-  store->context()->Enter();
+  store->enter();
   isolate->SetData(0, store.get());
+  store->built_ = true;
 
   return store;
 };
@@ -1059,23 +2361,13 @@ struct RefImpl : Ref, v8::Persistent<v8::Object> {
 
   auto get_host_info() const -> void* {
     v8::HandleScope handle_scope(isolate());
-    auto store = this->store();
-
-    v8::Local<v8::Value> args[] = { v8_object() };
-    auto maybe_result = store->v8_function(V8_F_WEAKMAP_GET)->Call(
-      store->context(), store->host_data_map(), 1, args);
-    if (maybe_result.IsEmpty()) return nullptr;
-    return wasm_v8::managed_get(maybe_result.ToLocalChecked());
+    auto host_info = store()->find_host_info(v8_object());
+    return host_info ? host_info->info : nullptr;
   }
 
   void set_host_info(void* info, void (*finalizer)(void*)) {
     v8::HandleScope handle_scope(isolate());
-    auto store = this->store();
-    auto managed = wasm_v8::managed_new(store->isolate(), info, finalizer);
-    v8::Local<v8::Value> args[] = { v8_object(), managed };
-    auto maybe_result = store->v8_function(V8_F_WEAKMAP_SET)->Call(
-      store->context(), store->host_data_map(), 2, args);
-    if (maybe_result.IsEmpty()) return;
+    store()->set_host_info(v8_object(), info, finalizer);
   }
 };
 
@@ -1150,10 +2442,10 @@ auto v8_to_ref(StoreImpl* store, v8::Local<v8::Value> value) -> own<Ref> {
 }
 
 auto v8_to_val(
-  StoreImpl* store, v8::Local<v8::Value> value, const ValType* t
+  StoreImpl* store, v8::Local<v8::Value> value, ValKind kind
 ) -> Val {
   auto context = store->context();
-  switch (t->kind()) {
+  switch (kind) {
     case ValKind::I32: return Val(value->Int32Value(context).ToChecked());
     case ValKind::I64: {
       auto bigint = value->ToBigInt(context).ToLocalChecked();
@@ -1171,6 +2463,12 @@ auto v8_to_val(
   }
 }
 
+auto v8_to_val(
+  StoreImpl* store, v8::Local<v8::Value> value, const ValType* t
+) -> Val {
+  return v8_to_val(store, value, t->kind());
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Runtime Objects
@@ -1263,28 +2561,114 @@ auto Trap::message() const -> Message {
   return vec<byte_t>::make_nt(std::string(*string));
 }
 
-auto Trap::origin() const -> own<Frame> {
-  // TODO(v8): implement
-  return own<Frame>(nullptr);
+auto Trap::interrupted() const -> bool {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  return impl(this)->v8_object()->HasPrivate(
+    store->context(), store->v8_private(V8_P_INTERRUPTED)).FromMaybe(false);
 }
 
-auto Trap::trace() const -> ownvec<Frame> {
-  // TODO(v8): implement
-  return ownvec<Frame>::make();
+namespace {
+
+// Must only be called once termination has been observed.
+auto interrupt_trap(StoreImpl* store) -> own<Trap> {
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  auto maybe_string = v8::String::NewFromUtf8(isolate, "interrupted",
+    v8::NewStringType::kNormal);
+  if (maybe_string.IsEmpty()) return own<Trap>();
+  auto exception = v8::Local<v8::Object>::Cast(
+    v8::Exception::Error(maybe_string.ToLocalChecked()));
+  ignore(exception->SetPrivate(store->context(),
+    store->v8_private(V8_P_INTERRUPTED), v8::True(isolate)));
+  return RefImpl<Trap>::make(store, exception);
 }
 
+}  // namespace
 
-// Foreign Objects
+namespace {
 
-template<> struct implement<Foreign> { using type = RefImpl<Foreign>; };
+auto make_frame(StoreImpl* store, const wasm_v8::stack_frame_t& frame)
+  -> own<Frame> {
+  auto instance = RefImpl<Instance>::make(store, frame.instance);
+  if (!instance) return own<Frame>();
+  return own<Frame>(new(std::nothrow) FrameImpl(std::move(instance),
+    frame.func_index, frame.func_offset, frame.module_offset));
+}
 
+}  // namespace
 
-void Foreign::destroy() {
-  impl(this)->~RefImpl<Foreign>();
+auto Trap::origin() const -> own<Frame> {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  wasm_v8::stack_frame_t frame;
+  if (wasm_v8::error_frames(impl(this)->v8_object(), &frame, 1) == 0) {
+    return own<Frame>();
+  }
+  return make_frame(store, frame);
 }
 
-auto Foreign::copy() const -> own<Foreign> {
-  return impl(this)->copy();
+auto Trap::trace() const -> ownvec<Frame> {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  auto error = impl(this)->v8_object();
+  auto depth = wasm_v8::error_frames(error, nullptr, 0);
+  small_array<wasm_v8::stack_frame_t> stack(depth);
+  wasm_v8::error_frames(error, stack.get(), depth);
+  auto frames = ownvec<Frame>::make_uninitialized(depth);
+  if (!frames) return ownvec<Frame>::invalid();
+  for (size_t i = 0; i < depth; ++i) {
+    frames[i] = make_frame(store, stack[i]);
+    if (!frames[i]) return ownvec<Frame>::invalid();
+  }
+  return frames;
+}
+
+
+// Profiles
+
+void Store::Profile::destroy() {
+  delete impl(this);
+}
+
+auto Store::Profile::samples() const -> size_t {
+  return impl(this)->starts.size();
+}
+
+auto Store::Profile::trace(size_t sample) const -> ownvec<Frame> {
+  auto self = impl(this);
+  if (sample >= self->starts.size()) return ownvec<Frame>::make();
+  auto isolate = self->store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  auto begin = self->starts[sample];
+  auto end = sample + 1 < self->starts.size() ?
+    self->starts[sample + 1] : self->frames.size();
+  auto frames = ownvec<Frame>::make_uninitialized(end - begin);
+  if (!frames) return ownvec<Frame>::invalid();
+  for (size_t i = begin; i < end; ++i) {
+    auto& frame = self->frames[i];
+    wasm_v8::stack_frame_t stack_frame = {
+      self->instances[frame.instance].Get(isolate),
+      frame.func_index, frame.func_offset, frame.module_offset
+    };
+    frames[i - begin] = make_frame(self->store, stack_frame);
+    if (!frames[i - begin]) return ownvec<Frame>::invalid();
+  }
+  return frames;
+}
+
+
+// Foreign Objects
+
+template<> struct implement<Foreign> { using type = RefImpl<Foreign>; };
+
+
+void Foreign::destroy() {
+  impl(this)->~RefImpl<Foreign>();
+}
+
+auto Foreign::copy() const -> own<Foreign> {
+  return impl(this)->copy();
 }
 
 auto Foreign::make(Store* store_abs) -> own<Foreign> {
@@ -1302,6 +2686,103 @@ auto Foreign::make(Store* store_abs) -> own<Foreign> {
 template<> struct implement<Module> { using type = RefImpl<Module>; };
 
 
+// Import and export types are decoded once per module binary and attached
+// to the module object, so that copies and shared modules see the same data.
+// Decoding is deferred until first use, and lookups by name only index the
+// export names in place, without decoding any types.
+
+struct ModuleData {
+  std::shared_ptr<void> native;  // owns the binary
+  vec<byte_t> binary;
+
+  std::once_flag types_decoded;
+  ownvec<ImportType> imports_ = ownvec<ImportType>::invalid();
+  ownvec<ExportType> exports_ = ownvec<ExportType>::invalid();
+
+  std::once_flag names_indexed;
+  std::vector<wasm::bin::name_ref> export_names;
+  std::unordered_multimap<uint64_t, size_t> export_indices;  // by name hash
+
+  ModuleData(std::shared_ptr<void>&& native, const byte_t* data, size_t size) :
+    native(std::move(native)),
+    binary(vec<byte_t>::adopt(size, const_cast<byte_t*>(data))) {}
+
+  ~ModuleData() {
+    binary.release();
+  }
+
+  void decode_types() {
+    std::call_once(types_decoded, [this] {
+      wasm::bin::externs(binary, imports_, exports_);
+    });
+  }
+
+  auto imports() -> const ownvec<ImportType>& {
+    decode_types();
+    return imports_;
+  }
+
+  auto exports() -> const ownvec<ExportType>& {
+    decode_types();
+    return exports_;
+  }
+
+  auto export_index(const Name& name) -> size_t {
+    std::call_once(names_indexed, [this] {
+      export_names = wasm::bin::export_names(binary);
+      for (size_t i = 0; i < export_names.size(); ++i) {
+        auto& name = export_names[i];
+        export_indices.emplace(hash_bytes(name.data, name.size), i);
+      }
+    });
+    auto range = export_indices.equal_range(hash_bytes(name.get(), name.size()));
+    for (auto it = range.first; it != range.second; ++it) {
+      auto& export_name = export_names[it->second];
+      if (export_name.size == name.size() &&
+          std::memcmp(export_name.data, name.get(), name.size()) == 0) {
+        return it->second;
+      }
+    }
+    return SIZE_MAX;
+  }
+};
+
+namespace {
+
+void finalize_module_data(void* data) {
+  delete reinterpret_cast<std::shared_ptr<ModuleData>*>(data);
+}
+
+auto set_module_data(
+  StoreImpl* store, v8::Local<v8::Object> module,
+  const std::shared_ptr<ModuleData>& data
+) -> const std::shared_ptr<ModuleData>& {
+  auto data_ptr = new std::shared_ptr<ModuleData>(data);
+  auto managed = wasm_v8::managed_new(
+    store->isolate(), data_ptr, &finalize_module_data);
+  ignore(module->SetPrivate(
+    store->context(), store->v8_private(V8_P_MODULE_DATA), managed));
+  return *data_ptr;
+}
+
+auto module_data(StoreImpl* store, v8::Local<v8::Object> module)
+  -> const std::shared_ptr<ModuleData>& {
+  auto maybe_managed = module->GetPrivate(
+    store->context(), store->v8_private(V8_P_MODULE_DATA));
+  if (!maybe_managed.IsEmpty()) {
+    auto data = wasm_v8::managed_get(maybe_managed.ToLocalChecked());
+    if (data) return *reinterpret_cast<std::shared_ptr<ModuleData>*>(data);
+  }
+
+  std::shared_ptr<ModuleData> data(new ModuleData(
+    wasm_v8::module_native(module), wasm_v8::module_binary(module),
+    wasm_v8::module_binary_size(module)));
+  return set_module_data(store, module, data);
+}
+
+}  // namespace
+
+
 void Module::destroy() {
   impl(this)->~RefImpl<Module>();
 }
@@ -1315,6 +2796,17 @@ auto Module::validate(Store* store_abs, const vec<byte_t>& binary) -> bool {
   v8::Isolate* isolate = store->isolate();
   v8::HandleScope handle_scope(isolate);
 
+  // With a module cache, validate by compiling, so that a subsequent make
+  // from the same bytes finds the module instead of checking them again.
+  // Modules known to be too large for the cache are only checked.
+  auto module_cache = store->engine()->module_cache.get();
+  if (module_cache) {
+    if (module_cache->find(binary)) return true;
+    if (!module_cache->oversized(binary)) {
+      return bool(Module::make(store_abs, binary));
+    }
+  }
+
   auto array_buffer = v8::ArrayBuffer::New(
     isolate, const_cast<byte_t*>(binary.get()), binary.size());
 
@@ -1332,27 +2824,68 @@ auto Module::make(Store* store_abs, const vec<byte_t>& binary) -> own<Module> {
   auto context = store->context();
   v8::HandleScope handle_scope(isolate);
 
+  auto module_cache = store->engine()->module_cache.get();
+  if (module_cache) {
+    auto entry = module_cache->find(binary);
+    if (entry) {
+      auto maybe_obj = wasm_v8::module_import(isolate, entry.native);
+      if (!maybe_obj.IsEmpty()) {
+        auto obj = maybe_obj.ToLocalChecked();
+        set_module_data(store, obj, entry.data);
+        return RefImpl<Module>::make(store, obj);
+      }
+    }
+  }
+  auto make = [&](v8::Local<v8::Object> obj) -> own<Module> {
+    if (module_cache) {
+      module_cache->insert(binary,
+        {wasm_v8::module_native(obj), module_data(store, obj)});
+    }
+    return RefImpl<Module>::make(store, obj);
+  };
+
+  auto& metrics = store->metrics();
+  auto code_cache = store->engine()->code_cache.get();
+  if (code_cache) {
+    auto artifact = code_cache->find(binary);
+    if (artifact) {
+      auto start = now_ns();
+      auto maybe_obj = wasm_v8::module_deserialize(isolate,
+        artifact.binary(), artifact.header()->binary_size,
+        artifact.native(), artifact.header()->native_size);
+      if (!maybe_obj.IsEmpty()) {
+        metrics.deserializations.add();
+        metrics.deserialize_ns.add(now_ns() - start);
+        return make(maybe_obj.ToLocalChecked());
+      }
+    }
+  }
+
   auto array_buffer = v8::ArrayBuffer::New(
     isolate, const_cast<byte_t*>(binary.get()), binary.size());
 
   v8::Local<v8::Value> args[] = {array_buffer};
+  auto start = now_ns();
   auto maybe_obj =
     store->v8_function(V8_F_MODULE)->NewInstance(context, 1, args);
   if (maybe_obj.IsEmpty()) return nullptr;
-  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
+  metrics.compilations.add();
+  metrics.compile_ns.add(now_ns() - start);
+  auto obj = maybe_obj.ToLocalChecked();
+
+  if (code_cache) {
+    code_cache->insert(binary, wasm_v8::module_serialize_size(obj),
+      [&](char* buffer, size_t size) {
+        return wasm_v8::module_serialize(obj, buffer, size);
+      });
+  }
+  return make(obj);
 }
 
 auto Module::imports() const -> ownvec<ImportType> {
   v8::HandleScope handle_scope(impl(this)->isolate());
   auto module = impl(this)->v8_object();
-  auto binary = vec<byte_t>::adopt(
-    wasm_v8::module_binary_size(module),
-    const_cast<byte_t*>(wasm_v8::module_binary(module))
-  );
-  auto imports = wasm::bin::imports(binary);
-  binary.release();
-  return imports;
-  // return impl(this)->data->imports.copy();
+  return module_data(impl(this)->store(), module)->imports().deep_copy();
 /* OBSOLETE?
   auto store = module->store();
   auto isolate = store->isolate();
@@ -1389,14 +2922,7 @@ auto Module::imports() const -> ownvec<ImportType> {
 auto Module::exports() const -> ownvec<ExportType> {
   v8::HandleScope handle_scope(impl(this)->isolate());
   auto module = impl(this)->v8_object();
-  auto binary = vec<byte_t>::adopt(
-    wasm_v8::module_binary_size(module),
-    const_cast<byte_t*>(wasm_v8::module_binary(module))
-  );
-  auto exports = wasm::bin::exports(binary);
-  binary.release();
-  return exports;
-  // return impl(this)->data->exports.copy();
+  return module_data(impl(this)->store(), module)->exports().deep_copy();
 /* OBSOLETE?
   auto store = module->store();
   auto isolate = store->isolate();
@@ -1451,17 +2977,199 @@ auto Module::deserialize(Store* store_abs, const vec<byte_t>& serialized) -> own
   auto binary_size = wasm::bin::u64(ptr);
   auto size_size = ptr - serialized.get();
   auto serial_size = serialized.size() - size_size - binary_size;
+  auto start = now_ns();
   auto maybe_obj = wasm_v8::module_deserialize(
     isolate, ptr, binary_size, ptr + binary_size, serial_size);
   if (maybe_obj.IsEmpty()) return nullptr;
+  store->metrics().deserializations.add();
+  store->metrics().deserialize_ns.add(now_ns() - start);
+  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
+}
+
+
+// Streaming Compilation
+
+struct StreamingModuleImpl : Module::Streaming {
+  StoreImpl* store;
+  std::shared_ptr<void> job;
+  bool done = false;
+
+  explicit StreamingModuleImpl(StoreImpl* store) :
+    store(store), job(wasm_v8::compile_start(store->context()))
+  {
+    stats.make(Stats::STREAMING_MODULE, this);
+  }
+
+  ~StreamingModuleImpl() {
+    if (!done) {
+      v8::HandleScope handle_scope(store->isolate());
+      wasm_v8::compile_abort(job);
+    }
+    stats.free(Stats::STREAMING_MODULE, this);
+  }
+};
+
+template<> struct implement<Module::Streaming> {
+  using type = StreamingModuleImpl;
+};
+
+
+void Module::Streaming::destroy() {
+  delete impl(this);
+}
+
+auto Module::make_streaming(Store* store_abs) -> own<Streaming> {
+  auto store = impl(store_abs);
+  v8::HandleScope handle_scope(store->isolate());
+  return own<Streaming>(new(std::nothrow) StreamingModuleImpl(store));
+}
+
+void Module::Streaming::feed(const byte_t* data, size_t size) {
+  auto self = impl(this);
+  if (self->done) return;
+  v8::HandleScope handle_scope(self->store->isolate());
+  wasm_v8::compile_feed(
+    self->job, reinterpret_cast<const uint8_t*>(data), size);
+}
+
+auto Module::Streaming::finish() -> own<Module> {
+  auto self = impl(this);
+  auto store = self->store;
+  v8::HandleScope handle_scope(store->isolate());
+  if (self->done) return nullptr;
+  self->done = true;
+
+  // Only the part of compilation not overlapped with feeding is counted.
+  auto start = now_ns();
+  wasm_v8::compile_finish(self->job);
+  while (wasm_v8::compile_state(self->job) == wasm_v8::COMPILE_PENDING) {
+    store->run_tasks(true);
+  }
+  auto maybe_obj = wasm_v8::compile_result(self->job);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  store->metrics().compilations.add();
+  store->metrics().compile_ns.add(now_ns() - start);
   return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
 }
 
+void Module::Streaming::abort() {
+  auto self = impl(this);
+  if (self->done) return;
+  self->done = true;
+  v8::HandleScope handle_scope(self->store->isolate());
+  wasm_v8::compile_abort(self->job);
+}
+
+
+// Asynchronous Compilation
+
+void Module::make_async(
+  Store* store_abs, const vec<byte_t>& binary,
+  async_callback callback, void* env
+) {
+  auto store = impl(store_abs);
+  v8::HandleScope handle_scope(store->isolate());
+  auto compilation = new AsyncCompilation(store->context(), callback, env);
+  wasm_v8::compile_feed(compilation->job,
+    reinterpret_cast<const uint8_t*>(binary.get()), binary.size());
+  wasm_v8::compile_finish(compilation->job);
+  store->async_compilations_.emplace_back(compilation);
+  store->run_tasks(false);
+}
+
+void Store::interrupt() {
+  impl(this)->interrupt();
+}
+
+void Store::set_timeout(uint32_t ms) {
+  impl(this)->set_timeout(ms);
+}
+
+void Store::collect_garbage(Collection collection) {
+  impl(this)->collect_garbage(collection);
+}
+
+auto Store::notify_idle(uint32_t ms) -> bool {
+  return impl(this)->notify_idle(ms);
+}
+
+void Store::set_heap_limit_callback(heap_limit_callback callback, void* env) {
+  impl(this)->set_heap_limit_callback(callback, env);
+}
+
+void Store::set_trace_depth(uint32_t depth) {
+  impl(this)->set_trace_depth(depth);
+}
+
+auto Store::start_profiling(uint32_t interval_us) -> bool {
+  return impl(this)->start_profiling(interval_us);
+}
+
+auto Store::stop_profiling() -> own<Profile> {
+  return impl(this)->stop_profiling();
+}
+
+auto Store::metrics() const -> Metrics {
+  auto store = impl(this);
+  auto& metrics = store->metrics();
+  Metrics result;
+  result.guest_calls = metrics.guest_calls.read(result.guest_call_ns);
+  result.host_calls = metrics.host_calls.read(result.host_call_ns);
+  result.compilations = metrics.compilations.get();
+  result.compile_ns = metrics.compile_ns.get();
+  result.deserializations = metrics.deserializations.get();
+  result.deserialize_ns = metrics.deserialize_ns.get();
+  result.instantiations = metrics.instantiations.get();
+  result.instantiate_ns = metrics.instantiate_ns.get();
+  result.live_handles = store->live_handles();
+  auto external = store->external_memory();
+  result.external_bytes = external > 0 ? external : 0;
+  return result;
+}
+
+auto Store::poll(bool wait) -> size_t {
+  auto store = impl(this);
+  v8::HandleScope handle_scope(store->isolate());
+  auto& pending = store->async_compilations_;
+  store->run_tasks(wait && !pending.empty());
+
+  // Take out settled compilations first, since callbacks may start new ones.
+  std::vector<std::unique_ptr<AsyncCompilation>> settled;
+  for (auto it = pending.begin(); it != pending.end();) {
+    if (wasm_v8::compile_state((*it)->job) != wasm_v8::COMPILE_PENDING) {
+      settled.push_back(std::move(*it));
+      it = pending.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (auto& compilation: settled) {
+    own<Module> module;
+    auto maybe_obj = wasm_v8::compile_result(compilation->job);
+    if (!maybe_obj.IsEmpty()) {
+      module = RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
+    }
+    compilation->callback(compilation->env, std::move(module));
+  }
+  return store->async_compilations_.size();
+}
 
-// TODO(v8): do better when V8 can do better.
+
+// Shared modules reference the same native module from every store,
+// so obtaining one neither copies nor recompiles code.
 
 template<class C>
-struct SharedImpl : Shared<C>, vec<byte_t> {
+struct SharedImpl : Shared<C> {
+  std::shared_ptr<void> native;
+  std::shared_ptr<ModuleData> data;
+
+  SharedImpl(std::shared_ptr<void>&& native,
+    const std::shared_ptr<ModuleData>& data
+  ) : native(std::move(native)), data(data) {
+    stats.make(categorize<C>::value, this, Stats::SHARED);
+  }
+
   void destroy() {
     stats.free(categorize<C>::value, this, Stats::SHARED);
     delete this;
@@ -1475,18 +3183,27 @@ void Shared<Module>::destroy() {
 }
 
 auto Module::share() const -> own<Shared<Module>> {
-  auto shared = static_cast<SharedImpl<Module>*>(new vec<byte_t>(serialize()));
-  stats.make(Stats::MODULE, shared, Stats::SHARED);
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto module = impl(this)->v8_object();
+  auto& data = module_data(impl(this)->store(), module);
+  auto shared = new(std::nothrow) SharedImpl<Module>(
+    wasm_v8::module_native(module), data);
   return own<Shared<Module>>(shared);
 }
 
-auto Module::obtain(Store* store, const Shared<Module>* shared) -> own<Module> {
-  return Module::deserialize(store, *impl(shared));
+auto Module::obtain(Store* store_abs, const Shared<Module>* shared)
+  -> own<Module> {
+  auto store = impl(store_abs);
+  v8::HandleScope handle_scope(store->isolate());
+  auto maybe_obj = wasm_v8::module_import(
+    store->isolate(), impl(shared)->native);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  auto obj = maybe_obj.ToLocalChecked();
+  set_module_data(store, obj, impl(shared)->data);
+  return RefImpl<Module>::make(store, obj);
 }
 
 
-
-
 // Externals
 
 template<> struct implement<Extern> { using type = RefImpl<Extern>; };
@@ -1567,10 +3284,11 @@ auto Func::copy() const -> own<Func> {
 struct FuncData {
   Store* store;
   own<FuncType> type;
-  enum Kind { CALLBACK, CALLBACK_WITH_ENV } kind;
+  enum Kind { CALLBACK, CALLBACK_WITH_ENV, ARRAY_CALLBACK_WITH_ENV } kind;
   union {
     Func::callback callback;
     Func::callback_with_env callback_with_env;
+    Func::array_callback_with_env array_callback_with_env;
   };
   void (*finalizer)(void*);
   void* env;
@@ -1616,7 +3334,8 @@ auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
 
   // Create wrapper instance
   auto binary = wasm::bin::wrapper(data->type.get());
-  auto module = Module::make(store_abs, binary);
+  auto maybe_module_obj = store->wrapper_module(binary);
+  if (maybe_module_obj.IsEmpty()) return own<Func>();
 
   auto imports_obj = v8::Object::New(isolate);
   auto module_obj = v8::Object::New(isolate);
@@ -1625,7 +3344,7 @@ auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
   ignore(module_obj->DefineOwnProperty(context, str, func_obj));
 
   v8::Local<v8::Value> instantiate_args[] = {
-    impl(module.get())->v8_object(), imports_obj
+    maybe_module_obj.ToLocalChecked(), imports_obj
   };
   auto instance_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
     context, 2, instantiate_args).ToLocalChecked();
@@ -1684,6 +3403,17 @@ auto Func::make(
   return make_func(store, data);
 }
 
+auto Func::make(
+  Store* store, const FuncType* type,
+  array_callback_with_env callback, void* env, void (*finalizer)(void*)
+) -> own<Func> {
+  auto data = new FuncData(store, type, FuncData::ARRAY_CALLBACK_WITH_ENV);
+  data->array_callback_with_env = callback;
+  data->env = env;
+  data->finalizer = finalizer;
+  return make_func(store, data);
+}
+
 auto Func::type() const -> own<FuncType> {
   // return impl(this)->data->type->copy();
   v8::HandleScope handle_scope(impl(this)->isolate());
@@ -1700,119 +3430,458 @@ auto Func::result_arity() const -> size_t {
   return wasm_v8::func_type_result_arity(impl(this)->v8_object());
 }
 
-auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
-  auto func = impl(this);
-  auto store = func->store();
-  auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+namespace {
 
-  auto context = store->context();
-  auto type = this->type();
-  auto& param_types = type->params();
-  auto& result_types = type->results();
+auto exception_trap(
+  StoreImpl* store, v8::Local<v8::Context> context,
+  v8::Local<v8::Value> exception
+) -> own<Trap> {
+  if (!exception->IsObject()) {
+    auto maybe_string = exception->ToString(context);
+    auto string = maybe_string.IsEmpty()
+      ? store->v8_string(V8_S_EMPTY) : maybe_string.ToLocalChecked();
+    exception = v8::Exception::Error(string);
+  }
+  return RefImpl<Trap>::make(store, v8::Local<v8::Object>::Cast(exception));
+}
 
-  // TODO: cache v8_args array per thread.
-  auto v8_args = std::unique_ptr<v8::Local<v8::Value>[]>(
-    new(std::nothrow) v8::Local<v8::Value>[param_types.size()]);
-  for (size_t i = 0; i < param_types.size(); ++i) {
-    assert(args[i].kind() == param_types[i]->kind());
+// Calls with numeric parameters and at most one numeric result bypass JS
+// value conversion and go through V8's C-to-Wasm entry stub instead.
+auto direct_callable(
+  size_t param_arity, const ValKind param_kinds[],
+  size_t result_arity, const ValKind result_kinds[]
+) -> bool {
+  if (result_arity > 1) return false;
+  for (size_t i = 0; i < param_arity; ++i) {
+    if (!is_num(param_kinds[i])) return false;
+  }
+  return result_arity == 0 || is_num(result_kinds[0]);
+}
+
+// Performs one direct call inside the caller's handle scope.
+auto call_func_direct_row(
+  StoreImpl* store, v8::Local<v8::Context> context,
+  v8::Local<v8::Function> v8_function,
+  size_t param_arity, const ValKind param_kinds[], const Val args[],
+  size_t result_arity, const ValKind result_kinds[], Val results[]
+) -> own<Trap> {
+  // Arguments are packed back to back, the result overwrites them.
+  small_array<int64_t> buffer(std::max(param_arity, size_t(1)));
+  auto packed = reinterpret_cast<char*>(buffer.get());
+  auto p = packed;
+  for (size_t i = 0; i < param_arity; ++i) {
+    assert(args[i].kind() == param_kinds[i]);
+    switch (param_kinds[i]) {
+      case ValKind::I32: {
+        auto x = args[i].i32(); std::memcpy(p, &x, sizeof x); p += sizeof x;
+      } break;
+      case ValKind::I64: {
+        auto x = args[i].i64(); std::memcpy(p, &x, sizeof x); p += sizeof x;
+      } break;
+      case ValKind::F32: {
+        auto x = args[i].f32(); std::memcpy(p, &x, sizeof x); p += sizeof x;
+      } break;
+      case ValKind::F64: {
+        auto x = args[i].f64(); std::memcpy(p, &x, sizeof x); p += sizeof x;
+      } break;
+      case ValKind::ANYREF:
+      case ValKind::FUNCREF:
+        assert(false);
+    }
+  }
+
+  v8::Local<v8::Value> exception;
+  wasm_v8::call_result_t result;
+  {
+    ExecutionScope execution(store);
+    auto start = now_ns();
+    result = wasm_v8::func_call_entry(
+      v8_function, packed, &exception, store->entry_cache());
+    store->metrics().guest_calls.record(now_ns() - start);
+  }
+  store->memory_may_grow();
+
+  switch (result) {
+    case wasm_v8::CALL_OK: break;
+    case wasm_v8::CALL_EXCEPTION: return exception_trap(store, context, exception);
+    case wasm_v8::CALL_TERMINATED: return interrupt_trap(store);
+  }
+
+  if (result_arity == 1) {
+    switch (result_kinds[0]) {
+      case ValKind::I32: {
+        int32_t x; std::memcpy(&x, packed, sizeof x); new (&results[0]) Val(x);
+      } break;
+      case ValKind::I64: {
+        int64_t x; std::memcpy(&x, packed, sizeof x); new (&results[0]) Val(x);
+      } break;
+      case ValKind::F32: {
+        float32_t x; std::memcpy(&x, packed, sizeof x); new (&results[0]) Val(x);
+      } break;
+      case ValKind::F64: {
+        float64_t x; std::memcpy(&x, packed, sizeof x); new (&results[0]) Val(x);
+      } break;
+      case ValKind::ANYREF:
+      case ValKind::FUNCREF:
+        assert(false);
+    }
+  }
+  return nullptr;
+}
+
+// Performs one call inside the caller's handle scope and try-catch.
+auto call_func_row(
+  StoreImpl* store, v8::Local<v8::Context> context,
+  v8::Local<v8::Function> v8_function, v8::TryCatch& handler,
+  size_t param_arity, const ValKind param_kinds[], const Val args[],
+  size_t result_arity, const ValKind result_kinds[], Val results[],
+  v8::Local<v8::Value> v8_args[]
+) -> own<Trap> {
+  auto isolate = store->isolate();
+
+  for (size_t i = 0; i < param_arity; ++i) {
+    assert(args[i].kind() == param_kinds[i]);
     v8_args[i] = val_to_v8(store, args[i]);
   }
 
-  v8::TryCatch handler(isolate);
-  auto v8_function = v8::Local<v8::Function>::Cast(func->v8_object());
-  auto maybe_val = v8_function->Call(
-    context, v8::Undefined(isolate), param_types.size(), v8_args.get());
+  v8::MaybeLocal<v8::Value> maybe_val;
+  bool terminated;
+  {
+    ExecutionScope execution(store);
+    auto start = now_ns();
+    maybe_val = v8_function->Call(
+      context, v8::Undefined(isolate), param_arity, v8_args);
+    store->metrics().guest_calls.record(now_ns() - start);
+    terminated = handler.HasTerminated();
+  }
+  store->memory_may_grow();
 
+  if (terminated) {
+    handler.Reset();
+    return interrupt_trap(store);
+  }
   if (handler.HasCaught()) {
     auto exception = handler.Exception();
-    if (!exception->IsObject()) {
-      auto maybe_string = exception->ToString(store->context());
-      auto string = maybe_string.IsEmpty()
-        ? store->v8_string(V8_S_EMPTY) : maybe_string.ToLocalChecked();
-      exception = v8::Exception::Error(string);
-    }
-    return RefImpl<Trap>::make(store, v8::Local<v8::Object>::Cast(exception));
+    handler.Reset();
+    return exception_trap(store, context, exception);
   }
 
   auto val = maybe_val.ToLocalChecked();
-  if (result_types.size() == 0) {
+  if (result_arity == 0) {
     assert(val->IsUndefined());
-  } else if (result_types.size() == 1) {
+  } else if (result_arity == 1) {
     assert(!val->IsUndefined());
-    new (&results[0]) Val(v8_to_val(store, val, result_types[0].get()));
+    new (&results[0]) Val(v8_to_val(store, val, result_kinds[0]));
   } else {
     assert(val->IsArray());
     auto array = v8::Handle<v8::Array>::Cast(val);
-    for (size_t i = 0; i < result_types.size(); ++i) {
-      auto maybe = array->Get(context, i);
-      assert(!maybe.IsEmpty());
-      new (&results[i]) Val(v8_to_val(
-        store, maybe.ToLocalChecked(), result_types[i].get()));
+    small_array<v8::Local<v8::Value>> v8_results(result_arity);
+    if (!wasm_v8::func_results(array, v8_results.get(), result_arity)) {
+      for (size_t i = 0; i < result_arity; ++i) {
+        auto maybe = array->Get(context, i);
+        assert(!maybe.IsEmpty());
+        v8_results[i] = maybe.ToLocalChecked();
+      }
+    }
+    for (size_t i = 0; i < result_arity; ++i) {
+      new (&results[i]) Val(v8_to_val(store, v8_results[i], result_kinds[i]));
     }
   }
   return nullptr;
 }
 
-void FuncData::v8_callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
-  auto v8_data = v8::Local<v8::Object>::Cast(info.Data());
-  auto self = reinterpret_cast<FuncData*>(wasm_v8::foreign_get(v8_data));
-  auto store = impl(self->store);
+auto call_func(
+  const RefImpl<Func>* func,
+  size_t param_arity, const ValKind param_kinds[], const Val args[],
+  size_t result_arity, const ValKind result_kinds[], Val results[],
+  v8::Local<v8::Value> v8_args[]
+) -> own<Trap> {
+  auto store = func->store();
+  v8::HandleScope handle_scope(store->isolate());
+  auto v8_function = v8::Local<v8::Function>::Cast(func->v8_object());
+  if (direct_callable(param_arity, param_kinds, result_arity, result_kinds)) {
+    return call_func_direct_row(store, store->context(), v8_function,
+      param_arity, param_kinds, args, result_arity, result_kinds, results);
+  }
+  v8::TryCatch handler(store->isolate());
+  return call_func_row(store, store->context(), v8_function, handler,
+    param_arity, param_kinds, args, result_arity, result_kinds, results,
+    v8_args);
+}
+
+// Rows are run in chunks sharing one handle scope, so that handles created
+// by argument and result conversion do not pile up over the whole batch.
+auto call_func_batch(
+  const RefImpl<Func>* func, size_t n,
+  size_t param_arity, const ValKind param_kinds[], const Val args[],
+  size_t result_arity, const ValKind result_kinds[], Val results[],
+  own<Trap> traps[], v8::Local<v8::Value> v8_args[]
+) -> size_t {
+  static const size_t chunk = 256;
+  auto store = func->store();
   auto isolate = store->isolate();
   v8::HandleScope handle_scope(isolate);
+  auto context = store->context();
+  auto v8_function = v8::Local<v8::Function>::Cast(func->v8_object());
+  auto direct =
+    direct_callable(param_arity, param_kinds, result_arity, result_kinds);
+  v8::TryCatch handler(isolate);
 
-  auto& param_types = self->type->params();
-  auto& result_types = self->type->results();
-
-  assert(param_types.size() == info.Length());
-
-  // TODO: cache params and result arrays per thread.
-  auto args = vec<Val>::make_uninitialized(param_types.size());
-  auto results = vec<Val>::make_uninitialized(result_types.size());
-  for (size_t i = 0; i < param_types.size(); ++i) {
-    args[i] = v8_to_val(store, info[i], param_types[i].get());
-  }
-
-  own<Trap> trap;
-  if (self->kind == CALLBACK_WITH_ENV) {
-    trap = self->callback_with_env(self->env, args, results);
-  } else {
-    trap = self->callback(args, results);
+  size_t trapped = 0;
+  for (size_t row = 0; row < n; ) {
+    v8::HandleScope chunk_scope(isolate);
+    for (size_t end = std::min(n, row + chunk); row < end; ++row) {
+      auto trap = direct
+        ? call_func_direct_row(store, context, v8_function,
+            param_arity, param_kinds, args + row * param_arity,
+            result_arity, result_kinds, results + row * result_arity)
+        : call_func_row(store, context, v8_function, handler,
+            param_arity, param_kinds, args + row * param_arity,
+            result_arity, result_kinds, results + row * result_arity, v8_args);
+      if (trap) ++trapped;
+      if (traps) traps[row] = std::move(trap);
+    }
   }
+  return trapped;
+}
 
-  if (trap) {
-    isolate->ThrowException(impl(trap.get())->v8_object());
-    return;
+// Stores the function's param kinds, followed by its result kinds.
+void func_kinds(
+  v8::Local<v8::Object> v8_func, size_t param_arity, size_t result_arity,
+  ValKind kinds[]
+) {
+  for (size_t i = 0; i < param_arity; ++i) {
+    kinds[i] = static_cast<ValKind>(wasm_v8::func_type_param(v8_func, i));
   }
-
-  auto ret = info.GetReturnValue();
-  if (result_types.size() == 0) {
-    ret.SetUndefined();
-  } else if (result_types.size() == 1) {
-    assert(results[0].kind() == result_types[0]->kind());
-    ret.Set(val_to_v8(store, results[0]));
-  } else {
-    auto context = store->context();
-    auto array = v8::Array::New(isolate, result_types.size());
-    for (size_t i = 0; i < result_types.size(); ++i) {
-      auto success = array->Set(context, i, val_to_v8(store, results[i]));
-      assert(success.IsJust() && success.ToChecked());
-    }
-    ret.Set(array);
+  for (size_t i = 0; i < result_arity; ++i) {
+    kinds[param_arity + i] =
+      static_cast<ValKind>(wasm_v8::func_type_result(v8_func, i));
   }
 }
 
-void FuncData::finalize_func_data(void* data) {
-  delete reinterpret_cast<FuncData*>(data);
-}
+}  // namespace
 
+auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
+  auto func = impl(this);
+  v8::HandleScope handle_scope(func->isolate());
+  auto v8_func = func->v8_object();
 
-// Global Instances
+  auto param_arity = wasm_v8::func_type_param_arity(v8_func);
+  auto result_arity = wasm_v8::func_type_result_arity(v8_func);
+  assert(args.size() >= param_arity);
+  assert(results.size() >= result_arity);
 
-template<> struct implement<Global> { using type = RefImpl<Global>; };
+  small_array<ValKind> kinds(param_arity + result_arity);
+  small_array<v8::Local<v8::Value>> v8_args(param_arity);
+  func_kinds(v8_func, param_arity, result_arity, kinds.get());
 
+  return call_func(func,
+    param_arity, kinds.get(), args.get(),
+    result_arity, kinds.get() + param_arity, results.get(), v8_args.get());
+}
 
-void Global::destroy() {
+auto Func::call_batch(
+  size_t n, const Val args[], Val results[], own<Trap> traps[]
+) const -> size_t {
+  auto func = impl(this);
+  v8::HandleScope handle_scope(func->isolate());
+  auto v8_func = func->v8_object();
+
+  auto param_arity = wasm_v8::func_type_param_arity(v8_func);
+  auto result_arity = wasm_v8::func_type_result_arity(v8_func);
+
+  small_array<ValKind> kinds(param_arity + result_arity);
+  small_array<v8::Local<v8::Value>> v8_args(param_arity);
+  func_kinds(v8_func, param_arity, result_arity, kinds.get());
+
+  return call_func_batch(func, n,
+    param_arity, kinds.get(), args,
+    result_arity, kinds.get() + param_arity, results, traps, v8_args.get());
+}
+
+
+// Prepared Calls
+
+struct PreparedFuncImpl : Func::Prepared {
+  own<Func> func;
+  size_t param_arity;
+  size_t result_arity;
+  std::unique_ptr<ValKind[]> kinds;  // params followed by results
+  std::unique_ptr<v8::Local<v8::Value>[]> v8_args;
+
+  PreparedFuncImpl(own<Func>&& func, size_t param_arity, size_t result_arity) :
+    func(std::move(func)), param_arity(param_arity), result_arity(result_arity),
+    kinds(new(std::nothrow) ValKind[param_arity + result_arity]),
+    v8_args(new(std::nothrow) v8::Local<v8::Value>[param_arity])
+  {
+    stats.make(Stats::PREPARED_FUNC, this);
+  }
+
+  ~PreparedFuncImpl() {
+    stats.free(Stats::PREPARED_FUNC, this);
+  }
+};
+
+template<> struct implement<Func::Prepared> { using type = PreparedFuncImpl; };
+
+
+void Func::Prepared::destroy() {
+  delete impl(this);
+}
+
+auto Func::prepare() const -> own<Prepared> {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto v8_func = impl(this)->v8_object();
+  auto param_arity = wasm_v8::func_type_param_arity(v8_func);
+  auto result_arity = wasm_v8::func_type_result_arity(v8_func);
+
+  auto func = copy();
+  if (!func) return own<Prepared>();
+  auto prepared = new(std::nothrow) PreparedFuncImpl(
+    std::move(func), param_arity, result_arity);
+  if (!prepared) return own<Prepared>();
+  if (!prepared->kinds || !prepared->v8_args) {
+    delete prepared;
+    return own<Prepared>();
+  }
+
+  func_kinds(v8_func, param_arity, result_arity, prepared->kinds.get());
+  return own<Prepared>(prepared);
+}
+
+auto Func::Prepared::func() const -> const Func* {
+  return impl(this)->func.get();
+}
+
+auto Func::Prepared::param_arity() const -> size_t {
+  return impl(this)->param_arity;
+}
+
+auto Func::Prepared::result_arity() const -> size_t {
+  return impl(this)->result_arity;
+}
+
+auto Func::Prepared::call(const vec<Val>& args, vec<Val>& results)
+  -> own<Trap> {
+  assert(args.size() >= param_arity());
+  assert(results.size() >= result_arity());
+  return call(args.get(), results.get());
+}
+
+auto Func::Prepared::call(const Val args[], Val results[]) -> own<Trap> {
+  auto self = impl(this);
+  return call_func(impl(self->func.get()),
+    self->param_arity, self->kinds.get(), args,
+    self->result_arity, self->kinds.get() + self->param_arity, results,
+    self->v8_args.get());
+}
+
+auto Func::Prepared::call_batch(
+  size_t n, const Val args[], Val results[], own<Trap> traps[]
+) -> size_t {
+  auto self = impl(this);
+  return call_func_batch(impl(self->func.get()), n,
+    self->param_arity, self->kinds.get(), args,
+    self->result_arity, self->kinds.get() + self->param_arity, results,
+    traps, self->v8_args.get());
+}
+
+namespace {
+
+void callback_return(
+  StoreImpl* store, const v8::FunctionCallbackInfo<v8::Value>& info,
+  const ownvec<ValType>& result_types, const Val results[]
+) {
+  auto ret = info.GetReturnValue();
+  if (result_types.size() == 0) {
+    ret.SetUndefined();
+  } else if (result_types.size() == 1) {
+    assert(results[0].kind() == result_types[0]->kind());
+    ret.Set(val_to_v8(store, results[0]));
+  } else {
+    small_array<v8::Local<v8::Value>> v8_results(result_types.size());
+    for (size_t i = 0; i < result_types.size(); ++i) {
+      assert(results[i].kind() == result_types[i]->kind());
+      v8_results[i] = val_to_v8(store, results[i]);
+    }
+    ret.Set(v8::Array::New(
+      store->isolate(), v8_results.get(), result_types.size()));
+  }
+}
+
+}  // namespace
+
+void FuncData::v8_callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  auto v8_data = v8::Local<v8::Object>::Cast(info.Data());
+  auto self = reinterpret_cast<FuncData*>(wasm_v8::foreign_get(v8_data));
+  auto store = impl(self->store);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  store->memory_may_grow();
+
+  auto& param_types = self->type->params();
+  auto& result_types = self->type->results();
+
+  assert(param_types.size() == info.Length());
+
+  if (self->kind == ARRAY_CALLBACK_WITH_ENV) {
+    small_array<Val> args(param_types.size());
+    small_array<Val> results(result_types.size());
+    for (size_t i = 0; i < param_types.size(); ++i) {
+      args[i] = v8_to_val(store, info[i], param_types[i]->kind());
+    }
+
+    auto start = now_ns();
+    auto trap = self->array_callback_with_env(
+      self->env, args.get(), results.get());
+    store->metrics().host_calls.record(now_ns() - start);
+    if (trap) {
+      // An interrupted nested call keeps unwinding by termination.
+      if (!isolate->IsExecutionTerminating()) {
+        isolate->ThrowException(impl(trap.get())->v8_object());
+      }
+      return;
+    }
+    callback_return(store, info, result_types, results.get());
+    return;
+  }
+
+  // TODO: cache params and result arrays per thread.
+  auto args = vec<Val>::make_uninitialized(param_types.size());
+  auto results = vec<Val>::make_uninitialized(result_types.size());
+  for (size_t i = 0; i < param_types.size(); ++i) {
+    args[i] = v8_to_val(store, info[i], param_types[i]->kind());
+  }
+
+  own<Trap> trap;
+  auto start = now_ns();
+  if (self->kind == CALLBACK_WITH_ENV) {
+    trap = self->callback_with_env(self->env, args, results);
+  } else {
+    trap = self->callback(args, results);
+  }
+  store->metrics().host_calls.record(now_ns() - start);
+
+  if (trap) {
+    if (!isolate->IsExecutionTerminating()) {
+      isolate->ThrowException(impl(trap.get())->v8_object());
+    }
+    return;
+  }
+  callback_return(store, info, result_types, results.get());
+}
+
+void FuncData::finalize_func_data(void* data) {
+  delete reinterpret_cast<FuncData*>(data);
+}
+
+
+// Global Instances
+
+template<> struct implement<Global> { using type = RefImpl<Global>; };
+
+
+void Global::destroy() {
   impl(this)->~RefImpl<Global>();
 }
 
@@ -1832,9 +3901,12 @@ auto Global::make(
 
   // Create wrapper instance
   auto binary = wasm::bin::wrapper(type);
-  auto module = Module::make(store_abs, binary);
+  auto maybe_module_obj = store->wrapper_module(binary);
+  if (maybe_module_obj.IsEmpty()) return own<Global>();
 
-  v8::Local<v8::Value> instantiate_args[] = { impl(module.get())->v8_object() };
+  v8::Local<v8::Value> instantiate_args[] = {
+    maybe_module_obj.ToLocalChecked()
+  };
   auto instance_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
     context, 1, instantiate_args).ToLocalChecked();
   auto exports_obj = wasm_v8::instance_exports(instance_obj);
@@ -1858,17 +3930,24 @@ auto Global::type() const -> own<GlobalType> {
   return GlobalType::make(ValType::make(kind), mutability);
 }
 
+auto Global::kind() const -> ValKind {
+  return static_cast<ValKind>(wasm_v8::global_type_content(*impl(this)));
+}
+
+// Numeric globals are accessed directly through the handle, without
+// opening a handle scope.
 auto Global::get() const -> Val {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto v8_global = impl(this)->v8_object();
-  switch (type()->content()->kind()) {
-    case ValKind::I32: return Val(wasm_v8::global_get_i32(v8_global));
-    case ValKind::I64: return Val(wasm_v8::global_get_i64(v8_global));
-    case ValKind::F32: return Val(wasm_v8::global_get_f32(v8_global));
-    case ValKind::F64: return Val(wasm_v8::global_get_f64(v8_global));
+  auto global = impl(this);
+  switch (kind()) {
+    case ValKind::I32: return Val(wasm_v8::global_get_i32(*global));
+    case ValKind::I64: return Val(wasm_v8::global_get_i64(*global));
+    case ValKind::F32: return Val(wasm_v8::global_get_f32(*global));
+    case ValKind::F64: return Val(wasm_v8::global_get_f64(*global));
     case ValKind::ANYREF:
     case ValKind::FUNCREF: {
-      auto store = impl(this)->store();
+      v8::HandleScope handle_scope(global->isolate());
+      auto v8_global = global->v8_object();
+      auto store = global->store();
       return Val(v8_to_ref(store, wasm_v8::global_get_ref(v8_global)));
     }
     default:
@@ -1877,16 +3956,17 @@ auto Global::get() const -> Val {
 }
 
 void Global::set(const Val& val) {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto v8_global = impl(this)->v8_object();
+  auto global = impl(this);
   switch (val.kind()) {
-    case ValKind::I32: return wasm_v8::global_set_i32(v8_global, val.i32());
-    case ValKind::I64: return wasm_v8::global_set_i64(v8_global, val.i64());
-    case ValKind::F32: return wasm_v8::global_set_f32(v8_global, val.f32());
-    case ValKind::F64: return wasm_v8::global_set_f64(v8_global, val.f64());
+    case ValKind::I32: return wasm_v8::global_set_i32(*global, val.i32());
+    case ValKind::I64: return wasm_v8::global_set_i64(*global, val.i64());
+    case ValKind::F32: return wasm_v8::global_set_f32(*global, val.f32());
+    case ValKind::F64: return wasm_v8::global_set_f64(*global, val.f64());
     case ValKind::ANYREF:
     case ValKind::FUNCREF: {
-      auto store = impl(this)->store();
+      v8::HandleScope handle_scope(global->isolate());
+      auto v8_global = global->v8_object();
+      auto store = global->store();
       return wasm_v8::global_set_ref(v8_global, ref_to_v8(store, val.ref()));
     }
     default:
@@ -1894,6 +3974,46 @@ void Global::set(const Val& val) {
   }
 }
 
+auto Global::get_i32() const -> int32_t {
+  assert(kind() == ValKind::I32);
+  return wasm_v8::global_get_i32(*impl(this));
+}
+
+auto Global::get_i64() const -> int64_t {
+  assert(kind() == ValKind::I64);
+  return wasm_v8::global_get_i64(*impl(this));
+}
+
+auto Global::get_f32() const -> float32_t {
+  assert(kind() == ValKind::F32);
+  return wasm_v8::global_get_f32(*impl(this));
+}
+
+auto Global::get_f64() const -> float64_t {
+  assert(kind() == ValKind::F64);
+  return wasm_v8::global_get_f64(*impl(this));
+}
+
+void Global::set_i32(int32_t val) {
+  assert(kind() == ValKind::I32);
+  wasm_v8::global_set_i32(*impl(this), val);
+}
+
+void Global::set_i64(int64_t val) {
+  assert(kind() == ValKind::I64);
+  wasm_v8::global_set_i64(*impl(this), val);
+}
+
+void Global::set_f32(float32_t val) {
+  assert(kind() == ValKind::F32);
+  wasm_v8::global_set_f32(*impl(this), val);
+}
+
+void Global::set_f64(float64_t val) {
+  assert(kind() == ValKind::F64);
+  wasm_v8::global_set_f64(*impl(this), val);
+}
+
 
 // Table Instances
 
@@ -1924,12 +4044,9 @@ auto Table::make(
   if (maybe_obj.IsEmpty()) return own<Table>();
   auto table = RefImpl<Table>::make(store, maybe_obj.ToLocalChecked());
   // TODO(wasm+): pass reference initialiser as parameter
-  if (table && ref) {
-    auto size = type->limits().min;
-    auto obj = maybe_obj.ToLocalChecked();
-    for (size_t i = 0; i < size; ++i) {
-      wasm_v8::table_set(obj, i, v8::Local<v8::Value>::Cast(init));
-    }
+  if (table && ref && !wasm_v8::table_fill(
+        maybe_obj.ToLocalChecked(), 0, type->limits().min, init)) {
+    return own<Table>();
   }
   return table;
 }
@@ -1969,6 +4086,50 @@ auto Table::grow(size_t delta, const Ref* ref) -> bool {
   return wasm_v8::table_grow(impl(this)->v8_object(), delta, val);
 }
 
+auto Table::fill(size_t index, size_t n, const Ref* ref) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto val = ref_to_v8(impl(this)->store(), ref);
+  return wasm_v8::table_fill(impl(this)->v8_object(), index, n, val);
+}
+
+auto Table::copy_range(
+  size_t index, const Table* src, size_t src_index, size_t n
+) -> bool {
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  return wasm_v8::table_copy(impl(this)->v8_object(), index,
+    impl(src)->v8_object(), src_index, n);
+}
+
+auto Table::get_range(size_t index, size_t n, own<Ref> refs[]) const -> bool {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  small_array<v8::Local<v8::Value>> values(n);
+  if (!wasm_v8::table_get_range(
+        impl(this)->v8_object(), index, n, values.get())) {
+    return false;
+  }
+  for (size_t i = 0; i < n; ++i) refs[i] = v8_to_ref(store, values[i]);
+  return true;
+}
+
+auto Table::get_range(size_t index, ownvec<Ref>& refs) const -> bool {
+  return get_range(index, refs.size(), refs.get());
+}
+
+auto Table::set_range(size_t index, size_t n, const Ref* const refs[])
+  -> bool {
+  auto store = impl(this)->store();
+  v8::HandleScope handle_scope(store->isolate());
+  small_array<v8::Local<v8::Value>> values(n);
+  for (size_t i = 0; i < n; ++i) values[i] = ref_to_v8(store, refs[i]);
+  return wasm_v8::table_set_range(
+    impl(this)->v8_object(), index, n, values.get());
+}
+
+auto Table::set_range(size_t index, const vec<Ref*>& refs) -> bool {
+  return set_range(index, refs.size(), refs.get());
+}
+
 
 // Memory Instances
 
@@ -1993,6 +4154,7 @@ auto Memory::make(Store* store_abs, const MemoryType* type) -> own<Memory> {
   auto maybe_obj =
     store->v8_function(V8_F_MEMORY)->NewInstance(context, 1, args);
   if (maybe_obj.IsEmpty()) return own<Memory>();
+  store->memory_may_grow();
   return RefImpl<Memory>::make(store, maybe_obj.ToLocalChecked());
 }
 
@@ -2022,10 +4184,247 @@ auto Memory::size() const -> pages_t {
 
 auto Memory::grow(pages_t delta) -> bool {
   v8::HandleScope handle_scope(impl(this)->isolate());
+  impl(this)->store()->memory_may_grow();
   return wasm_v8::memory_grow(impl(this)->v8_object(), delta);
 }
 
 
+// Memory Views
+
+struct MemoryViewImpl : Memory::View {
+  own<Memory> memory;
+  StoreImpl* store;
+  byte_t* base = nullptr;
+  size_t size = 0;
+  size_t epoch;
+
+  MemoryViewImpl(own<Memory>&& memory, StoreImpl* store) :
+    memory(std::move(memory)), store(store), epoch(store->memory_epoch() - 1)
+  {
+    stats.make(Stats::MEMORY_VIEW, this);
+  }
+
+  ~MemoryViewImpl() {
+    stats.free(Stats::MEMORY_VIEW, this);
+  }
+
+  void refresh() {
+    if (epoch == store->memory_epoch()) return;
+    auto memory = impl(this->memory.get());
+    v8::HandleScope handle_scope(memory->isolate());
+    base = wasm_v8::memory_data(memory->v8_object());
+    size = wasm_v8::memory_data_size(memory->v8_object());
+    epoch = store->memory_epoch();
+  }
+
+  auto check(size_t offset, size_t n) -> bool {
+    refresh();
+    return offset <= size && n <= size - offset;
+  }
+
+  auto check(const Memory::View::Segment segments[], size_t n) -> bool {
+    refresh();
+    for (size_t i = 0; i < n; ++i) {
+      auto& segment = segments[i];
+      if (segment.offset > size || segment.size > size - segment.offset) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template<> struct implement<Memory::View> { using type = MemoryViewImpl; };
+
+
+void Memory::View::destroy() {
+  delete impl(this);
+}
+
+auto Memory::view() const -> own<View> {
+  auto memory = copy();
+  if (!memory) return own<View>();
+  auto store = impl(this)->store();
+  return own<View>(new(std::nothrow) MemoryViewImpl(std::move(memory), store));
+}
+
+auto Memory::View::memory() const -> const Memory* {
+  return impl(this)->memory.get();
+}
+
+auto Memory::View::data() -> byte_t* {
+  impl(this)->refresh();
+  return impl(this)->base;
+}
+
+auto Memory::View::data_size() -> size_t {
+  impl(this)->refresh();
+  return impl(this)->size;
+}
+
+auto Memory::View::read(size_t offset, byte_t* dst, size_t size) -> bool {
+  auto self = impl(this);
+  if (!self->check(offset, size)) return false;
+  std::memcpy(dst, self->base + offset, size);
+  return true;
+}
+
+auto Memory::View::write(size_t offset, const byte_t* src, size_t size)
+  -> bool {
+  auto self = impl(this);
+  if (!self->check(offset, size)) return false;
+  std::memcpy(self->base + offset, src, size);
+  return true;
+}
+
+auto Memory::View::fill(size_t offset, byte_t value, size_t size) -> bool {
+  auto self = impl(this);
+  if (!self->check(offset, size)) return false;
+  std::memset(self->base + offset, value, size);
+  return true;
+}
+
+auto Memory::View::gather(const Segment segments[], size_t n) -> bool {
+  auto self = impl(this);
+  if (!self->check(segments, n)) return false;
+  for (size_t i = 0; i < n; ++i) {
+    auto& segment = segments[i];
+    std::memcpy(segment.data, self->base + segment.offset, segment.size);
+  }
+  return true;
+}
+
+auto Memory::View::scatter(const Segment segments[], size_t n) -> bool {
+  auto self = impl(this);
+  if (!self->check(segments, n)) return false;
+  for (size_t i = 0; i < n; ++i) {
+    auto& segment = segments[i];
+    std::memcpy(self->base + segment.offset, segment.data, segment.size);
+  }
+  return true;
+}
+
+
+// Memory Images
+
+struct MemoryImageImpl : Memory::Image {
+  int fd;
+  size_t offset;
+  size_t size;
+
+  MemoryImageImpl(int fd, size_t offset, size_t size) :
+    fd(fd), offset(offset), size(size)
+  {
+    stats.make(Stats::MEMORY_IMAGE, this);
+  }
+
+  ~MemoryImageImpl() {
+    close(fd);
+    stats.free(Stats::MEMORY_IMAGE, this);
+  }
+};
+
+template<> struct implement<Memory::Image> { using type = MemoryImageImpl; };
+
+
+void Memory::Image::destroy() {
+  delete impl(this);
+}
+
+// Host data is copied once into an anonymous file, which is what mappings
+// then share.
+auto Memory::Image::make(const byte_t* data, size_t size) -> own<Image> {
+  int fd = -1;
+#ifdef MFD_CLOEXEC
+  fd = memfd_create("wasm-memory-image", MFD_CLOEXEC);
+#endif
+  if (fd < 0) {
+    char path[] = "/tmp/wasm-memory-image.XXXXXX";
+    fd = mkstemp(path);
+    if (fd < 0) return own<Image>();
+    unlink(path);
+  }
+
+  void* base = MAP_FAILED;
+  if (size > 0 && ftruncate(fd, size) == 0) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (size > 0 && base == MAP_FAILED) {
+    close(fd);
+    return own<Image>();
+  }
+  if (size > 0) {
+    std::memcpy(base, data, size);
+    munmap(base, size);
+  }
+
+  auto image = new(std::nothrow) MemoryImageImpl(fd, 0, size);
+  if (!image) close(fd);
+  return own<Image>(image);
+}
+
+auto Memory::Image::make_from_file(int fd, size_t offset, size_t size)
+  -> own<Image> {
+  if (offset % sysconf(_SC_PAGESIZE) != 0) return own<Image>();
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      offset > size_t(st.st_size) || size > size_t(st.st_size) - offset) {
+    return own<Image>();
+  }
+  auto fd2 = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (fd2 < 0) return own<Image>();
+  auto image = new(std::nothrow) MemoryImageImpl(fd2, offset, size);
+  if (!image) close(fd2);
+  return own<Image>(image);
+}
+
+auto Memory::Image::size() const -> size_t {
+  return impl(this)->size;
+}
+
+auto Memory::make(
+  Store* store, const MemoryType* type, const Image* image
+) -> own<Memory> {
+  auto memory = make(store, type);
+  if (!memory || !memory->map(0, image)) return own<Memory>();
+  return memory;
+}
+
+// The image's whole pages replace the range with a private file mapping;
+// writes fault in private copies. A partial last page is copied. V8 grows
+// memories in place within their reservation, so the mapping survives growth.
+auto Memory::map(size_t offset, const Image* image_abs) -> bool {
+  auto image = impl(image_abs);
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  if (offset % page_size != 0) return false;
+
+  v8::HandleScope handle_scope(impl(this)->isolate());
+  auto base = wasm_v8::memory_data(impl(this)->v8_object());
+  auto size = wasm_v8::memory_data_size(impl(this)->v8_object());
+  if (offset > size || image->size > size - offset) return false;
+
+  auto mapped = image->size / page_size * page_size;
+  auto tail = image->size - mapped;
+  if ((mapped == 0 ||
+       mmap(base + offset, mapped, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_FIXED, image->fd, image->offset) != MAP_FAILED) &&
+      (tail == 0 ||
+       pread(image->fd, base + offset + mapped, tail, image->offset + mapped)
+         == ssize_t(tail))) {
+    return true;
+  }
+
+  // A failed fixed mapping may already have replaced part of the range,
+  // so the range is reset to zero pages instead, as in a fresh memory.
+  if (mapped > 0) {
+    mmap(base + offset, mapped, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+  }
+  std::memset(base + offset + mapped, 0, tail);
+  return false;
+}
+
+
 // Module Instances
 
 template<> struct implement<Instance> { using type = RefImpl<Instance>; };
@@ -2039,20 +4438,15 @@ auto Instance::copy() const -> own<Instance> {
   return impl(this)->copy();
 }
 
-auto Instance::make(
-  Store* store_abs, const Module* module_abs, const vec<Extern*>& imports,
-  own<Trap>* trap
-) -> own<Instance> {
-  auto store = impl(store_abs);
-  auto module = impl(module_abs);
+namespace {
+
+auto make_imports_obj(
+  StoreImpl* store, const ownvec<ImportType>& import_types,
+  const vec<Extern*>& imports
+) -> v8::MaybeLocal<v8::Object> {
   auto isolate = store->isolate();
   auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
-
-  assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
 
-  if (trap) *trap = nullptr;
-  auto import_types = module_abs->imports();
   auto imports_obj = v8::Object::New(isolate);
   for (size_t i = 0; i < import_types.size(); ++i) {
     auto type = import_types[i].get();
@@ -2060,13 +4454,13 @@ auto Instance::make(
       isolate, reinterpret_cast<const uint8_t*>(type->module().get()),
       v8::NewStringType::kNormal, type->module().size()
     );
-    if (maybe_module.IsEmpty()) return own<Instance>();
+    if (maybe_module.IsEmpty()) return v8::MaybeLocal<v8::Object>();
     auto module_str = maybe_module.ToLocalChecked();
     auto maybe_name = v8::String::NewFromOneByte(
       isolate, reinterpret_cast<const uint8_t*>(type->name().get()),
       v8::NewStringType::kNormal, type->name().size()
     );
-    if (maybe_name.IsEmpty()) return own<Instance>();
+    if (maybe_name.IsEmpty()) return v8::MaybeLocal<v8::Object>();
     auto name_str = maybe_name.ToLocalChecked();
 
     v8::Local<v8::Object> module_obj;
@@ -2081,77 +4475,604 @@ auto Instance::make(
     ignore(module_obj->DefineOwnProperty(
       context, name_str, extern_to_v8(imports[i])));
   }
+  return imports_obj;
+}
+
+auto instantiate(
+  StoreImpl* store, v8::Local<v8::Object> module_obj,
+  v8::Local<v8::Object> imports_obj, own<Trap>* trap
+) -> own<Instance> {
+  auto isolate = store->isolate();
+  auto context = store->context();
 
   v8::TryCatch handler(isolate);
-  v8::Local<v8::Value> instantiate_args[] = {module->v8_object(), imports_obj};
-  auto obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
-    context, 2, instantiate_args).ToLocalChecked();
+  v8::Local<v8::Value> instantiate_args[] = {module_obj, imports_obj};
+  v8::MaybeLocal<v8::Object> maybe_obj;
+  bool terminated;
+  {
+    ExecutionScope execution(store);
+    auto start = now_ns();
+    maybe_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
+      context, 2, instantiate_args);
+    if (!maybe_obj.IsEmpty()) {
+      store->metrics().instantiations.add();
+      store->metrics().instantiate_ns.add(now_ns() - start);
+    }
+    terminated = handler.HasTerminated();
+  }
+  store->memory_may_grow();
 
-  if (handler.HasCaught() && trap) {
-    auto exception = handler.Exception();
-    if (!exception->IsObject()) {
-      auto maybe_string = exception->ToString(store->context());
-      auto string = maybe_string.IsEmpty()
-        ? store->v8_string(V8_S_EMPTY) : maybe_string.ToLocalChecked();
-      exception = v8::Exception::Error(string);
+  if (terminated) {
+    handler.Reset();
+    if (trap) *trap = interrupt_trap(store);
+    return nullptr;
+  }
+  if (handler.HasCaught()) {
+    if (trap) {
+      auto exception = handler.Exception();
+      if (!exception->IsObject()) {
+        auto maybe_string = exception->ToString(store->context());
+        auto string = maybe_string.IsEmpty()
+          ? store->v8_string(V8_S_EMPTY) : maybe_string.ToLocalChecked();
+        exception = v8::Exception::Error(string);
+      }
+      *trap = RefImpl<Trap>::make(
+        store, v8::Local<v8::Object>::Cast(exception));
     }
-    *trap = RefImpl<Trap>::make(store, v8::Local<v8::Object>::Cast(exception));
     return nullptr;
   }
 
-  return RefImpl<Instance>::make(store, obj);
+  return RefImpl<Instance>::make(store, maybe_obj.ToLocalChecked());
+}
+
+}  // namespace
+
+auto Instance::make(
+  Store* store_abs, const Module* module_abs, const vec<Extern*>& imports,
+  own<Trap>* trap
+) -> own<Instance> {
+  auto store = impl(store_abs);
+  auto module = impl(module_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
+
+  if (trap) *trap = nullptr;
+  auto& import_types = module_data(store, module->v8_object())->imports();
+  auto maybe_imports_obj = make_imports_obj(store, import_types, imports);
+  if (maybe_imports_obj.IsEmpty()) return own<Instance>();
+
+  return instantiate(store,
+    module->v8_object(), maybe_imports_obj.ToLocalChecked(), trap);
+}
+
+
+// Prepared Instantiation
+
+struct PreparedInstanceImpl : Instance::Prepared {
+  StoreImpl* store;
+  v8::Persistent<v8::Object> module_obj;
+  v8::Persistent<v8::Object> imports_obj;
+
+  PreparedInstanceImpl(StoreImpl* store,
+    v8::Local<v8::Object> module_obj, v8::Local<v8::Object> imports_obj
+  ) :
+    store(store),
+    module_obj(store->isolate(), module_obj),
+    imports_obj(store->isolate(), imports_obj)
+  {
+    stats.make(Stats::PREPARED_INSTANCE, this);
+  }
+
+  ~PreparedInstanceImpl() {
+    module_obj.Reset();
+    imports_obj.Reset();
+    stats.free(Stats::PREPARED_INSTANCE, this);
+  }
+};
+
+template<> struct implement<Instance::Prepared> {
+  using type = PreparedInstanceImpl;
+};
+
+
+void Instance::Prepared::destroy() {
+  delete impl(this);
+}
+
+auto Instance::prepare(
+  Store* store_abs, const Module* module_abs, const vec<Extern*>& imports
+) -> own<Prepared> {
+  auto store = impl(store_abs);
+  auto module = impl(module_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
+
+  auto& import_types = module_data(store, module->v8_object())->imports();
+  auto maybe_imports_obj = make_imports_obj(store, import_types, imports);
+  if (maybe_imports_obj.IsEmpty()) return own<Prepared>();
+
+  return own<Prepared>(new(std::nothrow) PreparedInstanceImpl(
+    store, module->v8_object(), maybe_imports_obj.ToLocalChecked()));
+}
+
+auto Instance::Prepared::instantiate(own<Trap>* trap) const -> own<Instance> {
+  auto self = impl(this);
+  auto store = self->store;
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  if (trap) *trap = nullptr;
+  return wasm::instantiate(store,
+    self->module_obj.Get(isolate), self->imports_obj.Get(isolate), trap);
+}
+
+
+// Instance Snapshots
+
+struct InstanceSnapshotImpl : Instance::Snapshot {
+  // Table entries are the instance's own functions by index, or these.
+  enum : int64_t { NULL_ENTRY = -1, INITIAL_ENTRY = -2 };
+
+  struct TableState {
+    size_t size;
+    std::vector<int64_t> entries;
+  };
+
+  own<Shared<Module>> module;  // without start function
+  own<Memory::Image> memory;  // null if none
+  Memory::pages_t memory_pages = 0;
+  vec<byte_t> globals = vec<byte_t>::invalid();
+  std::vector<TableState> tables;
+
+  InstanceSnapshotImpl() { stats.make(Stats::INSTANCE_SNAPSHOT, this); }
+  ~InstanceSnapshotImpl() { stats.free(Stats::INSTANCE_SNAPSHOT, this); }
+};
+
+template<> struct implement<Instance::Snapshot> {
+  using type = InstanceSnapshotImpl;
+};
+
+
+void Instance::Snapshot::destroy() {
+  delete impl(this);
+}
+
+auto Instance::snapshot() const -> own<Snapshot> {
+  auto store = impl(this)->store();
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+  auto instance_obj = impl(this)->v8_object();
+
+  auto snapshot = std::unique_ptr<InstanceSnapshotImpl>(
+    new(std::nothrow) InstanceSnapshotImpl());
+  if (!snapshot) return own<Snapshot>();
+
+  // The module is compiled again without its start section, going through
+  // the module cache if there is one.
+  auto module_obj = wasm_v8::instance_module(instance_obj);
+  auto binary = vec<byte_t>::adopt(
+    wasm_v8::module_binary_size(module_obj),
+    const_cast<byte_t*>(wasm_v8::module_binary(module_obj))
+  );
+  auto stripped = wasm::bin::without_start(binary);
+  binary.release();
+  auto module = stripped
+    ? Module::make(store, stripped) : RefImpl<Module>::make(store, module_obj);
+  if (!module) return own<Snapshot>();
+  snapshot->module = module->share();
+  if (!snapshot->module) return own<Snapshot>();
+
+  auto maybe_memory_obj = wasm_v8::instance_memory(instance_obj);
+  if (!maybe_memory_obj.IsEmpty()) {
+    auto memory_obj = maybe_memory_obj.ToLocalChecked();
+    snapshot->memory_pages = wasm_v8::memory_size(memory_obj);
+    snapshot->memory = Memory::Image::make(wasm_v8::memory_data(memory_obj),
+      wasm_v8::memory_data_size(memory_obj));
+    if (!snapshot->memory) return own<Snapshot>();
+  }
+
+  snapshot->globals = vec<byte_t>::make_uninitialized(
+    wasm_v8::instance_globals_size(instance_obj));
+  wasm_v8::instance_globals_save(instance_obj, snapshot->globals.get());
+
+  std::vector<v8::Local<v8::Object>> table_objs(
+    wasm_v8::instance_tables(instance_obj, nullptr, 0));
+  wasm_v8::instance_tables(instance_obj, table_objs.data(), table_objs.size());
+  for (auto table_obj: table_objs) {
+    InstanceSnapshotImpl::TableState table;
+    table.size = wasm_v8::table_size(table_obj);
+    table.entries.resize(table.size, InstanceSnapshotImpl::INITIAL_ENTRY);
+    for (size_t i = 0; i < table.size; ++i) {
+      v8::HandleScope handle_scope(isolate);
+      auto maybe_value = wasm_v8::table_get(table_obj, i);
+      if (maybe_value.IsEmpty()) continue;
+      auto value = maybe_value.ToLocalChecked();
+      if (value->IsNull()) {
+        table.entries[i] = InstanceSnapshotImpl::NULL_ENTRY;
+      } else if (value->IsFunction()) {
+        auto func = v8::Local<v8::Function>::Cast(value);
+        if (wasm_v8::object_is_func(func) &&
+            wasm_v8::func_instance(func)->StrictEquals(instance_obj)) {
+          table.entries[i] = wasm_v8::func_index(func);
+        }
+      }
+    }
+    snapshot->tables.push_back(std::move(table));
+  }
+
+  return own<Snapshot>(snapshot.release());
 }
 
+auto Instance::Snapshot::instantiate(
+  Store* store_abs, const vec<Extern*>& imports, own<Trap>* trap
+) const -> own<Instance> {
+  auto self = impl(this);
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  if (trap) *trap = nullptr;
+  auto module = Module::obtain(store, self->module.get());
+  if (!module) return own<Instance>();
+  auto instance = Instance::make(store, module.get(), imports, trap);
+  if (!instance) return own<Instance>();
+  auto instance_obj = impl(instance.get())->v8_object();
+
+  if (self->memory) {
+    auto maybe_memory_obj = wasm_v8::instance_memory(instance_obj);
+    if (maybe_memory_obj.IsEmpty()) return own<Instance>();
+    auto memory = RefImpl<Memory>::make(
+      store, maybe_memory_obj.ToLocalChecked());
+    if (!memory) return own<Instance>();
+    auto pages = memory->size();
+    if (pages < self->memory_pages &&
+        !memory->grow(self->memory_pages - pages)) {
+      return own<Instance>();
+    }
+    if (!memory->map(0, self->memory.get())) return own<Instance>();
+  }
+
+  if (wasm_v8::instance_globals_size(instance_obj) != self->globals.size()) {
+    return own<Instance>();
+  }
+  wasm_v8::instance_globals_restore(instance_obj, self->globals.get());
+
+  std::vector<v8::Local<v8::Object>> table_objs(self->tables.size());
+  if (wasm_v8::instance_tables(instance_obj, table_objs.data(),
+        table_objs.size()) != table_objs.size()) {
+    return own<Instance>();
+  }
+  for (size_t t = 0; t < table_objs.size(); ++t) {
+    auto table_obj = table_objs[t];
+    auto& table = self->tables[t];
+    auto size = wasm_v8::table_size(table_obj);
+    if (size < table.size && !wasm_v8::table_grow(
+          table_obj, table.size - size, v8::Null(isolate))) {
+      return own<Instance>();
+    }
+    for (size_t i = 0; i < table.size; ++i) {
+      auto entry = table.entries[i];
+      if (entry == InstanceSnapshotImpl::INITIAL_ENTRY) continue;
+      v8::HandleScope handle_scope(isolate);
+      auto value = entry == InstanceSnapshotImpl::NULL_ENTRY
+        ? v8::Local<v8::Value>(v8::Null(isolate))
+        : v8::Local<v8::Value>(wasm_v8::instance_func(
+            instance_obj, static_cast<uint32_t>(entry)));
+      if (!wasm_v8::table_set(table_obj, i, value)) return own<Instance>();
+    }
+  }
+
+  return instance;
+}
+
+namespace {
+
+auto instance_export(
+  StoreImpl* store, v8::Local<v8::Object> exports_obj, const ExportType* type
+) -> own<Extern> {
+  auto isolate = store->isolate();
+  auto& name = type->name();
+  auto maybe_name_obj = v8::String::NewFromUtf8(isolate, name.get(),
+    v8::NewStringType::kInternalized, name.size());
+  if (maybe_name_obj.IsEmpty()) return nullptr;
+  auto name_obj = maybe_name_obj.ToLocalChecked();
+  auto obj = v8::Local<v8::Object>::Cast(
+    exports_obj->Get(store->context(), name_obj).ToLocalChecked());
+
+  switch (type->type()->kind()) {
+    case ExternKind::FUNC: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
+      return RefImpl<Func>::make(store, obj);
+    }
+    case ExternKind::GLOBAL: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
+      return RefImpl<Global>::make(store, obj);
+    }
+    case ExternKind::TABLE: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
+      return RefImpl<Table>::make(store, obj);
+    }
+    case ExternKind::MEMORY: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
+      return RefImpl<Memory>::make(store, obj);
+    }
+  }
+}
+
+}  // namespace
+
 auto Instance::exports() const -> ownvec<Extern> {
   auto instance = impl(this);
   auto store = instance->store();
-  auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
+  v8::HandleScope handle_scope(store->isolate());
 
   auto module_obj = wasm_v8::instance_module(instance->v8_object());
   auto exports_obj = wasm_v8::instance_exports(instance->v8_object());
   assert(!module_obj.IsEmpty() && module_obj->IsObject());
   assert(!exports_obj.IsEmpty() && exports_obj->IsObject());
 
-  auto module = RefImpl<Module>::make(store, module_obj);
-  auto export_types = module->exports();
+  auto& export_types = module_data(store, module_obj)->exports();
   auto exports = ownvec<Extern>::make_uninitialized(export_types.size());
   if (!exports) return ownvec<Extern>::invalid();
 
   for (size_t i = 0; i < export_types.size(); ++i) {
-    auto& name = export_types[i]->name();
-    auto maybe_name_obj = v8::String::NewFromUtf8(isolate, name.get(),
-      v8::NewStringType::kNormal, name.size());
-    if (maybe_name_obj.IsEmpty()) return ownvec<Extern>::invalid();
-    auto name_obj = maybe_name_obj.ToLocalChecked();
-    auto obj = v8::Local<v8::Object>::Cast(
-      exports_obj->Get(context, name_obj).ToLocalChecked());
-
-    auto type = export_types[i]->type();
-    switch (type->kind()) {
-      case ExternKind::FUNC: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
-        exports[i] = RefImpl<Func>::make(store, obj);
-      } break;
-      case ExternKind::GLOBAL: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
-        exports[i] = RefImpl<Global>::make(store, obj);
-      } break;
-      case ExternKind::TABLE: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
-        exports[i] = RefImpl<Table>::make(store, obj);
-      } break;
-      case ExternKind::MEMORY: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
-        exports[i] = RefImpl<Memory>::make(store, obj);
-      } break;
-    }
+    exports[i] = instance_export(store, exports_obj, export_types[i].get());
+    if (!exports[i]) return ownvec<Extern>::invalid();
   }
 
   return exports;
 }
 
+auto Instance::export_by_index(size_t index) const -> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  v8::HandleScope handle_scope(store->isolate());
+
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto& export_types = module_data(store, module_obj)->exports();
+  if (index >= export_types.size()) return nullptr;
+
+  auto exports_obj = wasm_v8::instance_exports(instance->v8_object());
+  return instance_export(store, exports_obj, export_types[index].get());
+}
+
+auto Instance::export_by_name(const Name& name) const -> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  v8::HandleScope handle_scope(store->isolate());
+
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto& data = module_data(store, module_obj);
+  auto index = data->export_index(name);
+  if (index == SIZE_MAX) return nullptr;
+
+  auto exports_obj = wasm_v8::instance_exports(instance->v8_object());
+  return instance_export(store, exports_obj, data->exports()[index].get());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Executors
+
+struct ExecutorImpl : Executor {
+  struct Job {
+    size_t index;
+    vec<Val> args = vec<Val>::invalid();
+    std::promise<Result> promise;
+    Executor::callback callback = nullptr;
+    void* env = nullptr;
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Job> jobs;  // owner takes from the front, thieves the back
+    std::thread thread;
+  };
+
+  Engine* engine;
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<size_t> next{0};
+
+  // Sleeping workers wait for pending jobs, counted across all queues.
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t pending = 0;
+  bool stopping = false;
+
+  ExecutorImpl(Engine* engine) : engine(engine) {
+    stats.make(Stats::EXECUTOR, this);
+  }
+
+  ~ExecutorImpl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cv.notify_all();
+    for (auto& worker: workers) {
+      if (worker->thread.joinable()) worker->thread.join();
+    }
+    stats.free(Stats::EXECUTOR, this);
+  }
+
+  void push(Job&& job) {
+    auto& worker = *workers[next++ % workers.size()];
+    // Queue the job before counting it, so that a woken worker finds it.
+    {
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.jobs.push_back(std::move(job));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++pending;
+    }
+    cv.notify_one();
+  }
+
+  auto pop(Worker& worker, bool steal, Job& job) -> bool {
+    {
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (worker.jobs.empty()) return false;
+      if (steal) {
+        job = std::move(worker.jobs.back());
+        worker.jobs.pop_back();
+      } else {
+        job = std::move(worker.jobs.front());
+        worker.jobs.pop_front();
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    --pending;
+    return true;
+  }
+
+  // Returns false once the executor is stopping and all jobs are done.
+  auto take(size_t i, Job& job) -> bool {
+    auto n = workers.size();
+    while (true) {
+      if (pop(*workers[i], false, job)) return true;
+      for (size_t k = 1; k < n; ++k) {
+        if (pop(*workers[(i + k) % n], true, job)) return true;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this] { return pending > 0 || stopping; });
+      if (pending == 0) return false;
+    }
+  }
+
+  static auto args_match(const vec<Val>& args, const std::vector<ValKind>& kinds)
+    -> bool {
+    for (size_t k = 0; k < args.size(); ++k) {
+      if (args[k].kind() != kinds[k]) return false;
+    }
+    return true;
+  }
+
+  void run(
+    size_t i, const Shared<Module>* shared, setup_callback setup, void* env,
+    std::promise<bool>* ready
+  ) {
+    auto store = Store::make(engine);
+    auto module = store ? Module::obtain(store.get(), shared) : own<Module>();
+    own<Instance> instance;
+    if (module) {
+      instance = setup ? setup(env, store.get(), module.get())
+        : Instance::make(store.get(), module.get(), vec<Extern*>::make());
+    }
+    // References cannot cross stores, so functions taking or returning
+    // them are left out like non-function exports.
+    std::vector<own<Func::Prepared>> funcs;
+    std::vector<std::vector<ValKind>> params;
+    if (instance) {
+      auto exports = instance->exports();
+      for (size_t k = 0; k < exports.size(); ++k) {
+        auto func = exports[k]->func();
+        auto type = func ? func->type() : own<FuncType>();
+        bool numeric = bool(type);
+        std::vector<ValKind> kinds;
+        if (type) {
+          for (size_t j = 0; j < type->params().size(); ++j) {
+            kinds.push_back(type->params()[j]->kind());
+            numeric &= type->params()[j]->is_num();
+          }
+          for (size_t j = 0; j < type->results().size(); ++j) {
+            numeric &= type->results()[j]->is_num();
+          }
+        }
+        funcs.push_back(numeric ? func->prepare() : own<Func::Prepared>());
+        params.push_back(std::move(kinds));
+      }
+    }
+    ready->set_value(bool(instance));
+    if (!instance) return;
+
+    Job job;
+    while (take(i, job)) {
+      Result result;
+      auto func = job.index < funcs.size() ? funcs[job.index].get() : nullptr;
+      if (!func) {
+        result.trap = Message::make_nt(std::string("export is not a numeric function"));
+      } else if (job.args.size() != func->param_arity()) {
+        result.trap = Message::make_nt(std::string("argument count mismatch"));
+      } else if (!args_match(job.args, params[job.index])) {
+        result.trap = Message::make_nt(std::string("argument type mismatch"));
+      } else {
+        auto results = vec<Val>::make_uninitialized(func->result_arity());
+        auto trap = func->call(job.args, results);
+        if (trap) {
+          result.trap = trap->message();
+        } else {
+          result.results = std::move(results);
+        }
+      }
+      if (job.callback) {
+        job.callback(job.env, result.results, result.trap ? &result.trap : nullptr);
+      } else {
+        job.promise.set_value(std::move(result));
+      }
+    }
+  }
+};
+
+template<> struct implement<Executor> { using type = ExecutorImpl; };
+
+
+void Executor::destroy() {
+  delete impl(this);
+}
+
+auto Executor::make(
+  Engine* engine, const Shared<Module>* shared, size_t threads,
+  setup_callback setup, void* env
+) -> own<Executor> {
+  if (threads == 0) return own<Executor>();
+  auto executor = own<ExecutorImpl>(new(std::nothrow) ExecutorImpl(engine));
+  if (!executor) return own<Executor>();
+  for (size_t i = 0; i < threads; ++i) {
+    executor->workers.emplace_back(new ExecutorImpl::Worker());
+  }
+
+  // Workers are ready once their store and instance are set up.
+  std::vector<std::promise<bool>> ready(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    executor->workers[i]->thread = std::thread(&ExecutorImpl::run,
+      executor.get(), i, shared, setup, env, &ready[i]);
+  }
+  bool success = true;
+  for (auto& promise: ready) success &= promise.get_future().get();
+  if (!success) return own<Executor>();
+  return own<Executor>(executor.release());
+}
+
+auto Executor::threads() const -> size_t {
+  return impl(this)->workers.size();
+}
+
+auto Executor::submit(size_t export_index, vec<Val>&& args)
+  -> std::future<Result> {
+  ExecutorImpl::Job job;
+  job.index = export_index;
+  job.args = std::move(args);
+  auto future = job.promise.get_future();
+  impl(this)->push(std::move(job));
+  return future;
+}
+
+void Executor::submit(
+  size_t export_index, vec<Val>&& args, callback callback, void* env
+) {
+  ExecutorImpl::Job job;
+  job.index = export_index;
+  job.args = std::move(args);
+  job.callback = callback;
+  job.env = env;
+  impl(this)->push(std::move(job));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }  // namespace wasm